@@ -3,100 +3,178 @@
 
 #include "Item.h"
 #include "Components/BoxComponent.h"
-#include "Components/WidgetComponent.h"
 #include "Components/SphereComponent.h"
 #include "Camera/CameraComponent.h"
 #include "ShooterCharacter.h"
+#include "ItemInterpSubsystem.h"
+#include "ItemSpatialSubsystem.h"
+#include "Engine/CollisionProfile.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Set Properties"), STAT_ItemSetProperties, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item State Transitions"), STAT_ItemStateTransitions, STATGROUP_Shooter);
+
+/** Collision profiles and physics flags applied to an item's components in one EItemState */
+struct FItemStateProperties
+{
+	FName MeshProfile;
+	FName BoxProfile;
+	bool bSimulatePhysics;
+	bool bEnableGravity;
+};
+
+/** Collision profiles for items, defined in DefaultEngine.ini */
+static const FName ItemPickupProfileName(TEXT("ItemPickup"));
+static const FName ItemFallingProfileName(TEXT("ItemFalling"));
+
+/** Precomputed properties for each item state, nullptr for states that leave the components untouched */
+static const FItemStateProperties* GetItemStateProperties(EItemState State)
+{
+	static const FItemStateProperties Pickup{ UCollisionProfile::NoCollision_ProfileName, ItemPickupProfileName, false, true };
+	static const FItemStateProperties Held{ UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, false, false };
+	static const FItemStateProperties Falling{ ItemFallingProfileName, UCollisionProfile::NoCollision_ProfileName, true, true };
+
+	switch (State)
+	{
+	case EItemState::EIS_Pickup:
+		return &Pickup;
+	case EItemState::EIS_EquipInterping:
+	case EItemState::EIS_Equipped:
+		return &Held;
+	case EItemState::EIS_Falling:
+		return &Falling;
+	default:
+		return nullptr;
+	}
+}
+
+FOnItemStateChanged AItem::OnItemStateChanged;
+
+static TAutoConsoleVariable<int32> CVarItemDormancy(
+	TEXT("Shooter.ItemDormancy"),
+	1,
+	TEXT("If non-zero, items lying in the world as pickups are net dormant until they change state."),
+	ECVF_Default);
 
 // Sets default values
 AItem::AItem() :
+	bHasScriptTick(false),
 	ItemName(FString("Default")),
 	ItemCount(0),
 	ItemRarity(EItemRarity::EIR_Common),
 	ItemState(EItemState::EIS_Pickup),
 	ZCurveTime(0.7f),
-	ItemInterpStartLocation(FVector(0.f)),
-	CameraTargetLocation(FVector(0.f)),
-	bIsInterping(false),
-	ItemInterpX(0.f),
-	ItemInterpY(0.f),
-	InterpInitialYawOffset(0.f)
+	bIsInterping(false)
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// Items don't tick. Interping is driven by UItemInterpSubsystem so idle items cost nothing per frame.
+	// Blueprints implementing Event Tick are still made tickable by the blueprint compiler
+	PrimaryActorTick.bCanEverTick = false;
+
+	// The server owns item state, clients follow it. Loot is only relevant close by
+	bReplicates = true;
+	SetReplicateMovement(true);
+	NetCullDistanceSquared = FMath::Square(5000.f);
+
+	// Placed pickups don't replicate until something changes them
+	NetDormancy = DORM_Initial;
 
 	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ItemMesh"));
 	SetRootComponent(ItemMesh);
 
 	CollisionBox = CreateDefaultSubobject<UBoxComponent>(TEXT("CollisionBox"));
 	CollisionBox->SetupAttachment(ItemMesh);
-	CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
-
-	PickupWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
-	PickupWidget->SetupAttachment(GetRootComponent());
+	CollisionBox->SetCollisionProfileName(ItemPickupProfileName);
 
+	// Proximity goes through the pickup grid, so the sphere never enters the physics scene
 	AreaSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AreaSphere"));
-	AreaSphere->SetupAttachment(GetRootComponent());
+	AreaSphere->SetupAttachment(ItemMesh);
+	AreaSphere->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	AreaSphere->SetGenerateOverlapEvents(false);
+	AreaSphere->SetCanEverAffectNavigation(false);
 }
 
 // Called when the game starts or when spawned
 void AItem::BeginPlay()
 {
-	Super::BeginPlay();
+	bHasScriptTick = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AActor, ReceiveTick));
 
-	if (PickupWidget)
-	{
-		/** Hide pickup widget by default */
-		PickupWidget->SetVisibility(false);
-	}
+	Super::BeginPlay();
 
 	SetActiveStars();
-	
-	/** Setup overlap for area sphere */
-	AreaSphere->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereOverlap);
-	AreaSphere->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
 
 	// Set item props based on item state
 	SetItemProperties(ItemState);
-}
+	UpdateSpatialIndex();
 
-void AItem::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
-{
-	if (OtherActor)
+	if (HasAuthority())
 	{
-		AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-		if (ShooterCharacter)
+		if (CVarItemDormancy.GetValueOnGameThread() == 0)
 		{
-			ShooterCharacter->IncrementOverlappedItemCount(1);
+			SetNetDormancy(DORM_Awake);
+		}
+		else if (ItemState == EItemState::EIS_Pickup && !IsNetStartupActor())
+		{
+			// Spawned pickups replicate once, then sleep like placed ones
+			GoDormant();
 		}
 	}
 }
 
-void AItem::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void AItem::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	if (OtherActor)
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Item state changes rarely, so it is only compared when marked dirty
+	FDoRepLifetimeParams PushParams;
+	PushParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AItem, ItemState, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AItem, ItemCount, PushParams);
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UItemSpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UItemSpatialSubsystem>();
+	if (SpatialSubsystem)
 	{
-		AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-		if (ShooterCharacter)
-		{
-			ShooterCharacter->IncrementOverlappedItemCount(-1);
-		}
+		SpatialSubsystem->RemoveItem(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+float AItem::GetPickupRadius() const
+{
+	return AreaSphere->GetScaledSphereRadius();
+}
+
+void AItem::UpdateSpatialIndex()
+{
+	UItemSpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UItemSpatialSubsystem>();
+	if (SpatialSubsystem == nullptr) return;
+
+	if (ItemState == EItemState::EIS_Pickup)
+	{
+		SpatialSubsystem->UpdateItem(this);
+	}
+	else
+	{
+		SpatialSubsystem->RemoveItem(this);
 	}
 }
 
 void AItem::StartItemCurve(AShooterCharacter* Char)
 {
+	// Already on its way to a character
+	if (bIsInterping) return;
+
 	// Store a handle to the character
 	Character = Char;
 
-	// Store initial location of the item
-	ItemInterpStartLocation = GetActorLocation();
 	bIsInterping = true;
 	SetItemState(EItemState::EIS_EquipInterping);
 
-	GetWorldTimerManager().SetTimer(ItemInterpTimer, this, &AItem::FinishInterping, ZCurveTime);
-
 	// Get initial yaw of component
 	const float CameraRotationYaw(Character->GetFollowCamera()->GetComponentRotation().Yaw);
 
@@ -104,59 +182,12 @@ void AItem::StartItemCurve(AShooterCharacter* Char)
 	const float ItemRotationYaw(GetActorRotation().Yaw);
 
 	// Initial yaw offset between item and camera
-	InterpInitialYawOffset = ItemRotationYaw - CameraRotationYaw;
-}
-
-void AItem::ItemInterp(float DeltaTime)
-{
-	if (!bIsInterping) return;
+	const float InterpInitialYawOffset = ItemRotationYaw - CameraRotationYaw;
 
-	if (Character && ItemZCurve)
+	UItemInterpSubsystem* InterpSubsystem = GetWorld()->GetSubsystem<UItemInterpSubsystem>();
+	if (InterpSubsystem)
 	{
-		// Elapsed time since we started the interp timer
-		const float ElapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
-
-		// Get the curve value from the ZCurve based on ElapsedTime
-		const float CurveValue = ItemZCurve->GetFloatValue(ElapsedTime);
-
-		// Get the items initial location when the curve started
-		FVector ItemLocation = ItemInterpStartLocation;
-
-		// Get location just in front of the camera
-		const FVector CameraInterpLocation(Character->GetCameraInterpLocation());
-
-		// Vector from item to camera inter location.
-		const FVector ItemToCamera(0.f, 0.f, (CameraInterpLocation - ItemLocation).Z);
-		
-		// Scale-factor to multiply with curve value
-		const float DeltaZ = ItemToCamera.Size();
-
-		// Interpolated X and Y values
-		const FVector CurrentLocation(GetActorLocation());
-		const float InterpXValue = FMath::FInterpTo(CurrentLocation.X, CameraInterpLocation.X, DeltaTime, 30.f);
-		const float InterpYValue = FMath::FInterpTo(CurrentLocation.Y, CameraInterpLocation.Y, DeltaTime, 30.f);
-
-		ItemLocation.X = InterpXValue;
-		ItemLocation.Y = InterpYValue;
-
-		// Update item location using curve value scaled by Delta-Z
-		ItemLocation.Z += CurveValue * DeltaZ;
-
-		SetActorLocation(ItemLocation, true, nullptr, ETeleportType::TeleportPhysics);
-
-		// Get camera rotation this frame
-		const FRotator CameraRotation(Character->GetFollowCamera()->GetComponentRotation());
-
-		// Camera rotation plus initial yaw offset
-		FRotator ItemRotation(0.f, CameraRotation.Yaw + InterpInitialYawOffset, 0.f);
-
-		SetActorRotation(ItemRotation, ETeleportType::TeleportPhysics);
-
-		if (ItemScaleCurve)
-		{
-			const float ScaleCurveValue = ItemScaleCurve->GetFloatValue(ElapsedTime);
-			SetActorScale3D(FVector(ScaleCurveValue, ScaleCurveValue, ScaleCurveValue));
-		}
+		InterpSubsystem->StartInterp(this, Character, InterpInitialYawOffset, ZCurveTime, ItemZCurve, ItemScaleCurve);
 	}
 }
 
@@ -211,95 +242,71 @@ void AItem::SetActiveStars()
 
 void AItem::SetItemProperties(EItemState State)
 {
-	switch (State)
-	{
-	case EItemState::EIS_Pickup:
-		//Set mesh props
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(true);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		// Set area sphere props
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-
-		// Set collision box props
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		break;
-
-	case EItemState::EIS_Equipped:
-		//Set mesh props
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		// Set area sphere props
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		// Set collision box props
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	const FItemStateProperties* Properties = GetItemStateProperties(State);
+	if (Properties == nullptr) return;
 
-		PickupWidget->SetVisibility(false);
-		break;
-	
-	case EItemState::EIS_EquipInterping:
-		PickupWidget->SetVisibility(false);
+	SCOPE_CYCLE_COUNTER(STAT_ItemSetProperties);
+	CSV_SCOPED_TIMING_STAT(Shooter, ItemSetProperties);
+	INC_DWORD_STAT(STAT_ItemStateTransitions);
+	CSV_CUSTOM_STAT(Shooter, ItemStateTransitions, 1, ECsvCustomStatOp::Accumulate);
 
-		//Set mesh props
+	// Stop simulating before the mesh profile drops its physics collision
+	if (!Properties->bSimulatePhysics && ItemMesh->IsSimulatingPhysics())
+	{
 		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		// Set area sphere props
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		// Set collision box props
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
+	}
+	if (ItemMesh->IsGravityEnabled() != Properties->bEnableGravity)
+	{
+		ItemMesh->SetEnableGravity(Properties->bEnableGravity);
+	}
+	ItemMesh->SetVisibility(true);
 
-	case EItemState::EIS_Falling:
-		// Set mesh props
+	// One profile switch per component. Item profiles have no overlap responses so overlaps are left alone
+	ItemMesh->SetCollisionProfileName(Properties->MeshProfile, false);
+	CollisionBox->SetCollisionProfileName(Properties->BoxProfile, false);
+
+	// Start simulating once the mesh has a profile that collides with the world
+	if (Properties->bSimulatePhysics && !ItemMesh->IsSimulatingPhysics())
+	{
 		ItemMesh->SetSimulatePhysics(true);
-		ItemMesh->SetEnableGravity(true);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_WorldStatic,ECollisionResponse::ECR_Block);
-
-		// Set area sphere props
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-
-		// Set collision box props
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
 	}
+}
+
+void AItem::SetItemState(EItemState NewItemState)
+{
+	ItemState = NewItemState;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AItem, ItemState, this);
+	SetItemProperties(ItemState);
+	UpdateSpatialIndex();
 
+	if (HasAuthority())
+	{
+		// Picked up or thrown, so it needs to replicate again
+		if (ItemState != EItemState::EIS_Pickup)
+		{
+			SetNetDormancy(DORM_Awake);
+		}
+		OnItemStateChanged.Broadcast(this);
+	}
 }
 
-// Called every frame
-void AItem::Tick(float DeltaTime)
+void AItem::SetItemCount(int32 NewItemCount)
 {
-	Super::Tick(DeltaTime);
-	ItemInterp(DeltaTime);
+	ItemCount = NewItemCount;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AItem, ItemCount, this);
+}
 
+void AItem::GoDormant()
+{
+	if (HasAuthority() && CVarItemDormancy.GetValueOnGameThread() != 0)
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
 }
 
-void AItem::SetItemState(EItemState NewItemState)
+void AItem::OnRep_ItemState()
 {
-	ItemState = NewItemState;
 	SetItemProperties(ItemState);
+	UpdateSpatialIndex();
 }
 
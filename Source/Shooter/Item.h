@@ -30,6 +30,8 @@ enum class EItemState : uint8
 	EIS_Max UMETA(DisplayName = "DefaultMAX")
 };
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnItemStateChanged, class AItem*);
+
 UCLASS()
 class SHOOTER_API AItem : public AActor
 {
@@ -39,17 +41,17 @@ public:
 	// Sets default values for this actor's properties
 	AItem();
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Broadcast on the server whenever an item changes state, so replication can re-route it */
+	static FOnItemStateChanged OnItemStateChanged;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	// Called when overlapping area sphere
-	UFUNCTION()
-	void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-	
-	// Called when end overlapping area sphere
-	UFUNCTION()
-	void OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+	// Called when the item is destroyed or the level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** Sets the active stars array of bools based on rarity */
 	void SetActiveStars();
@@ -57,14 +59,18 @@ protected:
 	/** Sets properties of the items components based on state */
 	void SetItemProperties(EItemState State);
 
-	/** Called when ItemInterpTimer is finished */
-	void FinishInterping();
+	/** Adds the item to the world's pickup grid while in the pickup state, removes it otherwise */
+	void UpdateSpatialIndex();
 
-	/** Handles item interpolation within the EquipInterping state */
-	void ItemInterp(float DeltaTime);
-public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	/** Applies the replicated item state on clients */
+	UFUNCTION()
+	void OnRep_ItemState();
+
+	/** Stops replicating the item until it next changes state (Shooter.ItemDormancy) */
+	void GoDormant();
+
+	/** True when a blueprint subclass implements Event Tick, which then has to keep ticking every frame */
+	bool bHasScriptTick;
 
 private:
 	/** Skeletal mesh for the item*/
@@ -75,11 +81,7 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class UBoxComponent* CollisionBox;
 
-	/** Popup widget UI for when the player looks at the item*/
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"));
-	class UWidgetComponent* PickupWidget;
-
-	/** Enables item tracing when overlapped */
+	/** Radius within which characters trace for this item. Only sizes its entry in UItemSpatialSubsystem, it has no collision */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"));
 	class USphereComponent* AreaSphere;
 
@@ -88,7 +90,7 @@ private:
 	FString ItemName;
 
 	/** Item count (ammo etc...) which appears on the pickup widget */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item Properties", meta = (AllowPrivateAccess = "true"));
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, Category = "Item Properties", meta = (AllowPrivateAccess = "true"));
 	int32 ItemCount;
 
 	/** Item Rarity determines number of stars in pickup widget*/
@@ -99,29 +101,18 @@ private:
 	TArray<bool> ActiveStars;
 	
 	/** State of the item*/
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_ItemState, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	EItemState ItemState;
 
 	/** Curve asset to use for the item's Z value when interping */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class UCurveFloat* ItemZCurve;
 
-	/** Starting location when interping begins */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	FVector ItemInterpStartLocation;
-
-	/** Target interp location in front of camera */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	FVector CameraTargetLocation;
-
 	/** True when interping */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	bool bIsInterping;
 
-	/** Plays when we start interping */
-	FTimerHandle ItemInterpTimer;
-
-	/** Duration of the timer based on the curve */
+	/** Duration of the interp based on the curve */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float ZCurveTime;
 
@@ -129,25 +120,29 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class AShooterCharacter* Character;
 
-	/** X and Y for the item whilst in the EquipInterping state */
-	float ItemInterpX;
-	float ItemInterpY;
-
-	/** Initial Yaw offset between the camera and the item*/
-	float InterpInitialYawOffset;
-
 	/** Curve to scale the item when interping */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	UCurveFloat* ItemScaleCurve;
 
 public:
-	FORCEINLINE UWidgetComponent* GetPickupWidget() const { return PickupWidget; };
-	FORCEINLINE USphereComponent* GetAreaSphere() const { return AreaSphere; };
 	FORCEINLINE UBoxComponent* GetCollisionBox() const { return CollisionBox; };
 	FORCEINLINE EItemState GetItemState() const { return ItemState; };
 	void SetItemState(EItemState NewItemState);
 	FORCEINLINE USkeletalMeshComponent* GetItemMesh() const { return ItemMesh; };
+	FORCEINLINE USphereComponent* GetAreaSphere() const { return AreaSphere; };
+
+	/** Scaled radius of AreaSphere */
+	float GetPickupRadius() const;
+	FORCEINLINE const FString& GetItemName() const { return ItemName; };
+	FORCEINLINE int32 GetItemCount() const { return ItemCount; };
+
+	UFUNCTION(BlueprintCallable, Category = "Item Properties")
+	void SetItemCount(int32 NewItemCount);
+	FORCEINLINE const TArray<bool>& GetActiveStars() const { return ActiveStars; };
 
 	// Called from the AShooterCharacter class
 	void StartItemCurve(AShooterCharacter* Char);
+
+	/** Called by UItemInterpSubsystem when the item has finished interping */
+	void FinishInterping();
 };
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemInterpSubsystem.h"
+#include "Camera/CameraComponent.h"
+#include "Curves/CurveFloat.h"
+#include "Item.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Interping Items"), STAT_InterpingItems, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Item Interp"), STAT_ItemInterp, STATGROUP_Shooter);
+
+void UItemInterpSubsystem::StartInterp(AItem* Item, AShooterCharacter* Character, float YawOffset, float Duration, UCurveFloat* ZCurve, UCurveFloat* ScaleCurve)
+{
+	FItemInterpEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Item = Item;
+	Entry.Character = Character;
+	Entry.StartLocation = Item->GetActorLocation();
+	Entry.YawOffset = YawOffset;
+	Entry.ElapsedTime = 0.f;
+	Entry.Duration = Duration;
+	Entry.ZCurve = ZCurve;
+	Entry.ScaleCurve = ScaleCurve;
+}
+
+void UItemInterpSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ItemInterp);
+	CSV_SCOPED_TIMING_STAT(Shooter, ItemInterp);
+	INC_DWORD_STAT_BY(STAT_InterpingItems, Entries.Num());
+	CSV_CUSTOM_STAT(Shooter, InterpingItems, Entries.Num(), ECsvCustomStatOp::Set);
+
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+	{
+		FItemInterpEntry& Entry = Entries[Index];
+		AItem* Item = Entry.Item.Get();
+		AShooterCharacter* Character = Entry.Character.Get();
+
+		Entry.ElapsedTime += DeltaTime;
+		if (Item == nullptr || Entry.ElapsedTime >= Entry.Duration)
+		{
+			// Finish after the loop as picking up an item can start other items interping
+			FinishedItems.Add(Entry.Item);
+			Entries.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if (Character && Entry.ZCurve)
+		{
+			// Get the curve value from the ZCurve based on ElapsedTime
+			const float CurveValue = Entry.ZCurve->GetFloatValue(Entry.ElapsedTime);
+
+			// Get the items initial location when the curve started
+			FVector ItemLocation = Entry.StartLocation;
+
+			// Get location just in front of the camera
+			const FVector CameraInterpLocation(Character->GetCameraInterpLocation());
+
+			// Scale-factor to multiply with curve value
+			const float DeltaZ = FMath::Abs(CameraInterpLocation.Z - ItemLocation.Z);
+
+			// Interpolated X and Y values
+			const FVector CurrentLocation(Item->GetActorLocation());
+			ItemLocation.X = FMath::FInterpTo(CurrentLocation.X, CameraInterpLocation.X, DeltaTime, 30.f);
+			ItemLocation.Y = FMath::FInterpTo(CurrentLocation.Y, CameraInterpLocation.Y, DeltaTime, 30.f);
+
+			// Update item location using curve value scaled by Delta-Z
+			ItemLocation.Z += CurveValue * DeltaZ;
+
+			// Camera rotation plus initial yaw offset
+			const float CameraYaw = Character->GetFollowCamera()->GetComponentRotation().Yaw;
+			const FRotator ItemRotation(0.f, CameraYaw + Entry.YawOffset, 0.f);
+
+			Item->SetActorLocationAndRotation(ItemLocation, ItemRotation, true, nullptr, ETeleportType::TeleportPhysics);
+
+			if (Entry.ScaleCurve)
+			{
+				const float ScaleCurveValue = Entry.ScaleCurve->GetFloatValue(Entry.ElapsedTime);
+				Item->SetActorScale3D(FVector(ScaleCurveValue));
+			}
+		}
+	}
+
+	for (const TWeakObjectPtr<AItem>& FinishedItem : FinishedItems)
+	{
+		if (FinishedItem.IsValid())
+		{
+			FinishedItem->FinishInterping();
+		}
+	}
+	FinishedItems.Reset();
+}
+
+bool UItemInterpSubsystem::IsTickable() const
+{
+	return Entries.Num() > 0;
+}
+
+ETickableTickType UItemInterpSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UItemInterpSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UItemInterpSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemInterpSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ItemInterpSubsystem.generated.h"
+
+class AItem;
+class AShooterCharacter;
+class UCurveFloat;
+
+/** Everything needed to move one item towards the camera while it is being picked up */
+struct FItemInterpEntry
+{
+	TWeakObjectPtr<AItem> Item;
+	TWeakObjectPtr<AShooterCharacter> Character;
+
+	/** Location of the item when interping began */
+	FVector StartLocation;
+
+	/** Initial yaw offset between the camera and the item */
+	float YawOffset;
+
+	/** Time since interping began and how long it lasts */
+	float ElapsedTime;
+	float Duration;
+
+	/** Curves for the item's Z value and scale. Owned by the item */
+	UCurveFloat* ZCurve;
+	UCurveFloat* ScaleCurve;
+};
+
+/**
+ * Drives every item in the EquipInterping state from a single tick, so that items
+ * themselves never need to tick while idle on the ground.
+ */
+UCLASS()
+class SHOOTER_API UItemInterpSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Starts interping an item towards the character's camera. AItem::FinishInterping is called when done */
+	void StartInterp(AItem* Item, AShooterCharacter* Character, float YawOffset, float Duration, UCurveFloat* ZCurve, UCurveFloat* ScaleCurve);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Items currently interping */
+	TArray<FItemInterpEntry> Entries;
+
+	/** Items which finished this tick, kept around to avoid reallocating every frame */
+	TArray<TWeakObjectPtr<AItem>> FinishedItems;
+};
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemSpatialSubsystem.h"
+#include "Item.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Indexed Pickup Items"), STAT_IndexedPickupItems, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Item Grid Queries"), STAT_ItemGridQueries, STATGROUP_Shooter);
+
+void UItemSpatialSubsystem::UpdateItem(AItem* Item)
+{
+	const FIntVector NewCell = GetCell(Item->GetActorLocation());
+
+	FIntVector* CurrentCell = ItemCells.Find(Item);
+	if (CurrentCell)
+	{
+		if (*CurrentCell == NewCell) return;
+
+		// Moved to a different cell
+		TArray<AItem*>& OldItems = Cells.FindChecked(*CurrentCell);
+		OldItems.RemoveSingleSwap(Item, false);
+		if (OldItems.Num() == 0)
+		{
+			Cells.Remove(*CurrentCell);
+		}
+		*CurrentCell = NewCell;
+	}
+	else
+	{
+		ItemCells.Add(Item, NewCell);
+		MaxPickupRadius = FMath::Max(MaxPickupRadius, Item->GetPickupRadius());
+		INC_DWORD_STAT(STAT_IndexedPickupItems);
+	}
+	Cells.FindOrAdd(NewCell).Add(Item);
+}
+
+void UItemSpatialSubsystem::RemoveItem(AItem* Item)
+{
+	FIntVector Cell;
+	if (ItemCells.RemoveAndCopyValue(Item, Cell))
+	{
+		TArray<AItem*>& CellItems = Cells.FindChecked(Cell);
+		CellItems.RemoveSingleSwap(Item, false);
+		if (CellItems.Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+		DEC_DWORD_STAT(STAT_IndexedPickupItems);
+	}
+}
+
+int32 UItemSpatialSubsystem::QueryItems(const FVector& Location, float Radius, TArray<AItem*>& OutItems) const
+{
+	const int32 NumBefore = OutItems.Num();
+	ForEachItemNear(Location, Radius, [&OutItems](AItem* Item)
+	{
+		OutItems.Add(Item);
+		return true;
+	});
+	return OutItems.Num() - NumBefore;
+}
+
+bool UItemSpatialSubsystem::HasItemInReach(const FVector& Location, float ExtraRadius) const
+{
+	bool bFound = false;
+	ForEachItemNear(Location, MaxPickupRadius + ExtraRadius, [&bFound, &Location, ExtraRadius](AItem* Item)
+	{
+		bFound = FVector::DistSquared(Item->GetActorLocation(), Location) <= FMath::Square(Item->GetPickupRadius() + ExtraRadius);
+		return !bFound;
+	});
+	return bFound;
+}
+
+FIntVector UItemSpatialSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
+
+template<typename VisitorType>
+void UItemSpatialSubsystem::ForEachItemNear(const FVector& Location, float Radius, VisitorType Visitor) const
+{
+	INC_DWORD_STAT(STAT_ItemGridQueries);
+
+	const FIntVector MinCell = GetCell(Location - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Location + FVector(Radius));
+	const float RadiusSquared = Radius * Radius;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<AItem*>* CellItems = Cells.Find(FIntVector(X, Y, Z));
+				if (CellItems == nullptr) continue;
+
+				for (AItem* Item : *CellItems)
+				{
+					if (FVector::DistSquared(Item->GetActorLocation(), Location) <= RadiusSquared)
+					{
+						if (!Visitor(Item)) return;
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemSpatialSubsystem.generated.h"
+
+class AItem;
+
+/**
+ * Uniform grid of every item in the EIS_Pickup state, so characters can find nearby
+ * pickups by radius without each item carrying an overlap body in the physics scene.
+ * Items keep their own entry up to date when they change state or finish moving, and
+ * each one is in reach within its own pickup radius.
+ */
+UCLASS()
+class SHOOTER_API UItemSpatialSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Adds the item, or moves it to the cell for its current location if already indexed */
+	void UpdateItem(AItem* Item);
+
+	/** Removes the item if indexed */
+	void RemoveItem(AItem* Item);
+
+	/** Appends every indexed item within Radius of Location to OutItems. Returns the number found */
+	int32 QueryItems(const FVector& Location, float Radius, TArray<AItem*>& OutItems) const;
+
+	/** True if Location is within the pickup radius of any indexed item, widened by ExtraRadius */
+	bool HasItemInReach(const FVector& Location, float ExtraRadius) const;
+
+	FORCEINLINE int32 GetNumItems() const { return ItemCells.Num(); };
+
+private:
+	FIntVector GetCell(const FVector& Location) const;
+
+	/** Calls Visitor for each indexed item within Radius of Location until it returns false */
+	template<typename VisitorType>
+	void ForEachItemNear(const FVector& Location, float Radius, VisitorType Visitor) const;
+
+	/** Size of a grid cell in world units */
+	float CellSize = 500.f;
+
+	/** Largest pickup radius of any item indexed so far, bounding the cells HasItemInReach visits */
+	float MaxPickupRadius = 0.f;
+
+	/** Items in each occupied cell */
+	TMap<FIntVector, TArray<AItem*>> Cells;
+
+	/** Cell each indexed item is currently in */
+	TMap<AItem*, FIntVector> ItemCells;
+};
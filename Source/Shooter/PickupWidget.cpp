@@ -0,0 +1,13 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupWidget.h"
+#include "Item.h"
+
+void UPickupWidget::SetItem(AItem* NewItem)
+{
+	if (Item == NewItem) return;
+
+	Item = NewItem;
+	OnItemChanged();
+}
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "PickupWidget.generated.h"
+
+class AItem;
+
+/**
+ * Base class for the pickup widget. One instance is shared by each local player and
+ * re-targeted to whichever item they are looking at.
+ */
+UCLASS()
+class SHOOTER_API UPickupWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/** Points the widget at a new item and lets blueprint rebind name, count and stars */
+	void SetItem(AItem* NewItem);
+
+protected:
+	/** Called when the widget has been pointed at a different item */
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnItemChanged();
+
+private:
+	/** Item the widget is currently showing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item", meta = (AllowPrivateAccess = "true"))
+	AItem* Item;
+};
@@ -2,5 +2,35 @@
 
 #include "Shooter.h"
 #include "Modules/ModuleManager.h"
+#include "Engine/NetDriver.h"
+#include "Misc/CommandLine.h"
+#include "ShooterReplicationGraph.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Shooter, "Shooter" );
+DEFINE_LOG_CATEGORY(LogShooter);
+
+CSV_DEFINE_CATEGORY(Shooter, true);
+
+class FShooterModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// The game net driver uses UShooterReplicationGraph, -NoRepGraph keeps the default driver for comparison
+		if (!FParse::Param(FCommandLine::Get(), TEXT("NoRepGraph")))
+		{
+			UReplicationDriver::CreateReplicationDriverDelegate().BindLambda([](UNetDriver* ForNetDriver, const FURL& URL, UWorld* World) -> UReplicationDriver*
+			{
+				if (ForNetDriver->NetDriverName != NAME_GameNetDriver) return nullptr;
+
+				return NewObject<UShooterReplicationGraph>(GetTransientPackage());
+			});
+		}
+	}
+
+	virtual void ShutdownModule() override
+	{
+		UReplicationDriver::CreateReplicationDriverDelegate().Unbind();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FShooterModule, Shooter, "Shooter" );
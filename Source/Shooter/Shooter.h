@@ -3,4 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+/** Stat group for Shooter gameplay code. Use "stat Shooter" to view */
+DECLARE_STATS_GROUP(TEXT("Shooter"), STATGROUP_Shooter, STATCAT_Advanced);
+
+/** CSV profiler category with the same timings and counts as STATGROUP_Shooter. Use "csvprofile start" to capture */
+CSV_DECLARE_CATEGORY_EXTERN(Shooter);
+
+DECLARE_LOG_CATEGORY_EXTERN(LogShooter, Log, All);
 
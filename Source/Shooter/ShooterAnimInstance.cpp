@@ -3,42 +3,99 @@
 #include "ShooterAnimInstance.h"
 #include "ShooterCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "Kismet/KismetMathLibrary.h"
+#include "Shooter.h"
 
-void UShooterAnimInstance::NativeInitializeAnimation()
+DECLARE_CYCLE_STAT(TEXT("Anim Proxy PreUpdate"), STAT_AnimProxyPreUpdate, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Anim Proxy Update"), STAT_AnimProxyUpdate, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Anim Graph Update"), STAT_AnimGraphUpdate, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Anim Graph Evaluate"), STAT_AnimGraphEvaluate, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Graph Evaluations"), STAT_AnimGraphEvaluations, STATGROUP_Shooter);
+
+void FShooterAnimInstanceProxy::Initialize(UAnimInstance* InAnimInstance)
 {
-	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+	FAnimInstanceProxy::Initialize(InAnimInstance);
+
+	ShooterAnimInstance = CastChecked<UShooterAnimInstance>(InAnimInstance);
 }
 
-void UShooterAnimInstance::UpdateAnimationProperties(float DeltaTime)
+void FShooterAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
 {
-	if (ShooterCharacter == nullptr)
+	SCOPE_CYCLE_COUNTER(STAT_AnimProxyPreUpdate);
+	CSV_SCOPED_TIMING_STAT(Shooter, AnimProxyPreUpdate);
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+	UShooterAnimInstance* AnimInstance = CastChecked<UShooterAnimInstance>(InAnimInstance);
+	if (AnimInstance->ShooterCharacter == nullptr)
 	{
-		ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+		AnimInstance->ShooterCharacter = Cast<AShooterCharacter>(AnimInstance->TryGetPawnOwner());
 	}
 
-	if (ShooterCharacter)
+	// Only copy values here, anything worth computing is done in Update
+	const AShooterCharacter* Character = AnimInstance->ShooterCharacter;
+	bHasCharacter = Character != nullptr;
+	if (bHasCharacter)
 	{
-		// Get speed of character from velocity
-		FVector Velocity = ShooterCharacter->GetVelocity();
-		Velocity.Z = 0;
-		Speed = Velocity.Size();
-
-		// Is the character in the air
-		bIsInAir = ShooterCharacter->GetCharacterMovement()->IsFalling();
-
-		// Is the character accelerating
-		bIsAccelerating = ShooterCharacter->GetCharacterMovement()->GetCurrentAcceleration().Size() > 0.f;
-
-		FRotator AimRotation = ShooterCharacter->GetBaseAimRotation();
-		FRotator MovementRotation = UKismetMathLibrary::MakeRotFromX(ShooterCharacter->GetVelocity());
-		MovementOffsetYaw = UKismetMathLibrary::NormalizedDeltaRotator(MovementRotation, AimRotation).Yaw;
-		
-		if (ShooterCharacter->GetVelocity().Size() > 0.f)
-		{
-			LastMovementOffsetYaw = MovementOffsetYaw;
-		}
-
-		bAiming = ShooterCharacter->GetAiming();
+		const UCharacterMovementComponent* CharacterMovement = Character->GetCharacterMovement();
+		Velocity = Character->GetVelocity();
+		bIsFalling = CharacterMovement->IsFalling();
+		bHasAcceleration = !CharacterMovement->GetCurrentAcceleration().IsZero();
+		AimRotation = Character->GetBaseAimRotation();
+		bCharacterAiming = Character->GetAiming();
 	}
 }
+
+void FShooterAnimInstanceProxy::Update(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimProxyUpdate);
+	CSV_SCOPED_TIMING_STAT(Shooter, AnimProxyUpdate);
+	FAnimInstanceProxy::Update(DeltaSeconds);
+
+	if (!bHasCharacter) return;
+
+	// Speed across the ground
+	ShooterAnimInstance->Speed = Velocity.Size2D();
+	ShooterAnimInstance->bIsInAir = bIsFalling;
+	ShooterAnimInstance->bIsAccelerating = bHasAcceleration;
+
+	const FRotator MovementRotation = Velocity.Rotation();
+	ShooterAnimInstance->MovementOffsetYaw = (MovementRotation - AimRotation).GetNormalized().Yaw;
+
+	if (!Velocity.IsZero())
+	{
+		ShooterAnimInstance->LastMovementOffsetYaw = ShooterAnimInstance->MovementOffsetYaw;
+	}
+
+	ShooterAnimInstance->bAiming = bCharacterAiming;
+}
+
+void FShooterAnimInstanceProxy::UpdateAnimationNode(const FAnimationUpdateContext& InContext)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimGraphUpdate);
+	FAnimInstanceProxy::UpdateAnimationNode(InContext);
+}
+
+void FShooterAnimInstanceProxy::EvaluateAnimationNode(FPoseContext& Output)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimGraphEvaluate);
+	INC_DWORD_STAT(STAT_AnimGraphEvaluations);
+	FAnimInstanceProxy::EvaluateAnimationNode(Output);
+}
+
+void UShooterAnimInstance::NativeInitializeAnimation()
+{
+	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+}
+
+void UShooterAnimInstance::UpdateAnimationProperties(float DeltaTime)
+{
+}
+
+FAnimInstanceProxy* UShooterAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FShooterAnimInstanceProxy(this);
+}
+
+void UShooterAnimInstance::DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy)
+{
+	delete InProxy;
+}
@@ -4,8 +4,46 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "ShooterAnimInstance.generated.h"
 
+class UShooterAnimInstance;
+
+/**
+ * Gathers what the anim graph needs from the character on the game thread in PreUpdate,
+ * then works out the animation properties in Update, which runs on a worker thread
+ * alongside every other character's animation update.
+ */
+USTRUCT()
+struct FShooterAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FShooterAnimInstanceProxy() {}
+	FShooterAnimInstanceProxy(UAnimInstance* InAnimInstance) : FAnimInstanceProxy(InAnimInstance) {}
+
+protected:
+	virtual void Initialize(UAnimInstance* InAnimInstance) override;
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+	virtual void Update(float DeltaSeconds) override;
+
+	/** Timed so the cost of the graph at each update rate shows in stat Shooter */
+	virtual void UpdateAnimationNode(const FAnimationUpdateContext& InContext) override;
+	virtual void EvaluateAnimationNode(FPoseContext& Output) override;
+
+private:
+	/** Instance whose properties Update writes. Nothing else touches them while the update runs */
+	UShooterAnimInstance* ShooterAnimInstance = nullptr;
+
+	/** Game thread snapshot of the owning character, taken in PreUpdate */
+	bool bHasCharacter = false;
+	FVector Velocity = FVector::ZeroVector;
+	bool bIsFalling = false;
+	bool bHasAcceleration = false;
+	FRotator AimRotation = FRotator::ZeroRotator;
+	bool bCharacterAiming = false;
+};
+
 UCLASS()
 class SHOOTER_API UShooterAnimInstance : public UAnimInstance
 {
@@ -14,10 +52,17 @@ class SHOOTER_API UShooterAnimInstance : public UAnimInstance
 public:
 	virtual void NativeInitializeAnimation() override;
 
-	UFUNCTION(BlueprintCallable)
+	/** No longer needed, the properties are updated by FShooterAnimInstanceProxy off the game thread */
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Animation properties are updated natively, remove this call from the event graph"))
 		void UpdateAnimationProperties(float DeltaTime);
 
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override;
+
 private:
+	friend struct FShooterAnimInstanceProxy;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement", meta = (AllowPrivateAccess = "true"))
 	class AShooterCharacter* ShooterCharacter;
 
@@ -0,0 +1,1138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/ReplicationDriver.h"
+#include "Item.h"
+#include "ShooterCharacter.h"
+#include "ShooterFireBurstComponent.h"
+#include "ShooterLagCompensationSubsystem.h"
+#include "TimerManager.h"
+#include "UObject/UObjectIterator.h"
+#include "Particles/ParticleSystem.h"
+#include "Sound/SoundBase.h"
+#include "Blueprint/UserWidget.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/Controller.h"
+#include "AIController.h"
+#include "RenderCore.h"
+#include "Weapon.h"
+#include "ShooterInventoryComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/StaticMesh.h"
+#include "Components/StaticMeshComponent.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "Containers/Ticker.h"
+#include "Misc/AutomationTest.h"
+#include "ShooterProjectileSubsystem.h"
+#include "Shooter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "Tests/AutomationCommon.h"
+#endif
+
+namespace ShooterBenchmarks
+{
+	/** Spawns copies of the first item in the level (or plain items) scattered around Origin. Returns the class spawned */
+	static UClass* SpawnItemCopies(UWorld* World, int32 NumItems, float Extent, TArray<AItem*>& OutItems, const FVector& Origin = FVector::ZeroVector)
+	{
+		// Clone a placed item so the benchmark runs against real meshes and bodies
+		AItem* Template = nullptr;
+		for (TActorIterator<AItem> It(World); It; ++It)
+		{
+			Template = *It;
+			break;
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Template = Template;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		UClass* ItemClass = Template ? Template->GetClass() : AItem::StaticClass();
+
+		OutItems.Reserve(OutItems.Num() + NumItems);
+		for (int32 i = 0; i < NumItems; i++)
+		{
+			const FVector Location = Origin + FVector(FMath::FRandRange(-Extent, Extent), FMath::FRandRange(-Extent, Extent), 500.f);
+			AItem* Item = World->SpawnActor<AItem>(ItemClass, Location, FRotator::ZeroRotator, SpawnParams);
+			if (Item)
+			{
+				OutItems.Add(Item);
+			}
+		}
+		return ItemClass;
+	}
+
+	/** Spawns copies of the first item in the level (or plain items) and times cycling them through every item state */
+	static void BenchItemStates(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr) return;
+
+		const int32 NumItems = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2000;
+		const int32 NumCycles = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 4;
+
+		TArray<AItem*> Items;
+		UClass* ItemClass = SpawnItemCopies(World, NumItems, 5000.f, Items);
+
+		static const EItemState States[] = {
+			EItemState::EIS_EquipInterping,
+			EItemState::EIS_Equipped,
+			EItemState::EIS_Falling,
+			EItemState::EIS_Pickup
+		};
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Cycle = 0; Cycle < NumCycles; Cycle++)
+		{
+			for (EItemState State : States)
+			{
+				for (AItem* Item : Items)
+				{
+					Item->SetItemState(State);
+				}
+			}
+		}
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		const int32 NumTransitions = Items.Num() * NumCycles * UE_ARRAY_COUNT(States);
+
+		UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.ItemStates: %d items (%s), %d transitions in %.2f ms, %.3f us per transition"),
+			Items.Num(), *ItemClass->GetName(), NumTransitions, ElapsedMs,
+			NumTransitions > 0 ? ElapsedMs * 1000.0 / NumTransitions : 0.0);
+
+		for (AItem* Item : Items)
+		{
+			Item->Destroy();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchItemStatesCommand(
+		TEXT("Shooter.Bench.ItemStates"),
+		TEXT("Times item state transitions. Usage: Shooter.Bench.ItemStates [NumItems=2000] [Cycles=4]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchItemStates));
+
+	/** Holds the fire button on the locally controlled characters for a while, then logs their fire burst bandwidth */
+	static void BenchFireBurst(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr) return;
+
+		const float Seconds = Args.Num() > 0 ? FMath::Max(1.f, FCString::Atof(*Args[0])) : 10.f;
+
+		TArray<TWeakObjectPtr<AShooterCharacter>> Shooters;
+		for (TActorIterator<AShooterCharacter> It(World); It; ++It)
+		{
+			if (It->IsLocallyControlled())
+			{
+				It->GetFireBurst()->ResetNetStats();
+				It->SetFireButtonHeld(true);
+				Shooters.Add(*It);
+			}
+		}
+
+		FTimerHandle TimerHandle;
+		World->GetTimerManager().SetTimer(TimerHandle, FTimerDelegate::CreateLambda([Shooters]()
+		{
+			for (const TWeakObjectPtr<AShooterCharacter>& Shooter : Shooters)
+			{
+				if (Shooter.IsValid())
+				{
+					Shooter->SetFireButtonHeld(false);
+					Shooter->GetFireBurst()->FlushBurst();
+					Shooter->GetFireBurst()->LogNetStats();
+				}
+			}
+		}), Seconds, false);
+	}
+
+	/** Logs fire burst bandwidth for every character in the world, per firing client when run on the server */
+	static void FireBurstReport(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr) return;
+
+		const bool bReset = Args.Num() > 0 && Args[0] == TEXT("reset");
+		for (TActorIterator<AShooterCharacter> It(World); It; ++It)
+		{
+			if (bReset)
+			{
+				It->GetFireBurst()->ResetNetStats();
+			}
+			else
+			{
+				It->GetFireBurst()->LogNetStats();
+			}
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchFireBurstCommand(
+		TEXT("Shooter.Bench.FireBurst"),
+		TEXT("Holds fire on the local characters and logs the bytes per second they send. Usage: Shooter.Bench.FireBurst [Seconds=10]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchFireBurst));
+
+	static FAutoConsoleCommandWithWorldAndArgs FireBurstReportCommand(
+		TEXT("Shooter.Net.FireBurstReport"),
+		TEXT("Logs fire burst bytes, RPCs and shots per second for each character. Usage: Shooter.Net.FireBurstReport [reset]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FireBurstReport));
+
+	/** Logs lag compensation history memory and rewind cost */
+	static void LagCompensationReport(UWorld* World)
+	{
+		const UShooterLagCompensationSubsystem* LagCompensation = World ? World->GetSubsystem<UShooterLagCompensationSubsystem>() : nullptr;
+		if (LagCompensation)
+		{
+			LagCompensation->LogReport();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorld LagCompensationReportCommand(
+		TEXT("Shooter.LagComp.Report"),
+		TEXT("Logs lag compensation history memory per character and the average rewind cost per shot."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&LagCompensationReport));
+
+	/** Accumulates how long the game net driver spends flushing replication each frame */
+	struct FNetTickBench
+	{
+		TWeakObjectPtr<UWorld> World;
+		double EndTime = 0.0;
+		double FrameStart = 0.0;
+		double TotalSeconds = 0.0;
+		int32 NumFrames = 0;
+		FDelegateHandle TickFlushHandle;
+		FDelegateHandle PostTickFlushHandle;
+	};
+	static TSharedPtr<FNetTickBench> ActiveNetTickBench;
+
+	static void FinishNetTickBench()
+	{
+		TSharedPtr<FNetTickBench> Bench = ActiveNetTickBench;
+		ActiveNetTickBench.Reset();
+
+		UWorld* World = Bench->World.Get();
+		if (World == nullptr) return;
+
+		World->OnTickFlush().Remove(Bench->TickFlushHandle);
+		World->OnPostTickFlush().Remove(Bench->PostTickFlushHandle);
+
+		int32 NumItems = 0;
+		for (TActorIterator<AItem> It(World); It; ++It)
+		{
+			NumItems++;
+		}
+
+		const UNetDriver* NetDriver = World->GetNetDriver();
+		const UReplicationDriver* ReplicationDriver = NetDriver ? NetDriver->GetReplicationDriver() : nullptr;
+		UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.NetTick: %d clients, %d items, %s: %.3f ms average net tick over %d frames"),
+			NetDriver ? NetDriver->ClientConnections.Num() : 0, NumItems,
+			ReplicationDriver ? *ReplicationDriver->GetClass()->GetName() : TEXT("default net driver"),
+			Bench->NumFrames > 0 ? Bench->TotalSeconds * 1000.0 / Bench->NumFrames : 0.0, Bench->NumFrames);
+	}
+
+	/**
+	 * Times the server's net tick (the net drivers' tick flush, where replication runs) for a number
+	 * of seconds, optionally scattering extra items around the map first
+	 */
+	static void BenchNetTick(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || World->GetNetMode() == NM_Client || ActiveNetTickBench.IsValid()) return;
+
+		const float Seconds = Args.Num() > 0 ? FMath::Max(1.f, FCString::Atof(*Args[0])) : 30.f;
+		const int32 ExtraItems = Args.Num() > 1 ? FMath::Max(0, FCString::Atoi(*Args[1])) : 0;
+
+		TArray<AItem*> Items;
+		SpawnItemCopies(World, ExtraItems, 50000.f, Items);
+
+		TSharedPtr<FNetTickBench> Bench = MakeShared<FNetTickBench>();
+		Bench->World = World;
+		Bench->EndTime = FPlatformTime::Seconds() + Seconds;
+		// Multicast delegates call the most recently added handler first, so this runs just before the
+		// net drivers' TickFlush and the window leaves out actor ticks, timers and tickable subsystems
+		Bench->TickFlushHandle = World->OnTickFlush().AddLambda([Bench](float DeltaSeconds)
+		{
+			Bench->FrameStart = FPlatformTime::Seconds();
+		});
+		Bench->PostTickFlushHandle = World->OnPostTickFlush().AddLambda([Bench](float DeltaSeconds)
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (Bench->FrameStart > 0.0)
+			{
+				Bench->TotalSeconds += Now - Bench->FrameStart;
+				Bench->NumFrames++;
+			}
+			if (Now >= Bench->EndTime)
+			{
+				FinishNetTickBench();
+			}
+		});
+		ActiveNetTickBench = Bench;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchNetTickCommand(
+		TEXT("Shooter.Bench.NetTick"),
+		TEXT("Server only. Logs the average net tick time with the current clients. Usage: Shooter.Bench.NetTick [Seconds=30] [ExtraItems=0]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchNetTick));
+
+	/** Spawned characters running around while their animation cost is measured */
+	struct FAnimBench
+	{
+		TWeakObjectPtr<UWorld> World;
+		TArray<TWeakObjectPtr<AShooterCharacter>> Characters;
+		double EndTime = 0.0;
+		double GameThreadMs = 0.0;
+		int32 NumFrames = 0;
+		FDelegateHandle TickStartHandle;
+	};
+	static TSharedPtr<FAnimBench> ActiveAnimBench;
+
+	static void FinishAnimBench()
+	{
+		TSharedPtr<FAnimBench> Bench = ActiveAnimBench;
+		ActiveAnimBench.Reset();
+
+		FWorldDelegates::OnWorldTickStart.Remove(Bench->TickStartHandle);
+
+		const IConsoleVariable* ParallelAnimUpdate = IConsoleManager::Get().FindConsoleVariable(TEXT("a.ParallelAnimUpdate"));
+		UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.Anim: %d characters, parallel anim update %s: %.3f ms average game thread time over %d frames"),
+			Bench->Characters.Num(), ParallelAnimUpdate && ParallelAnimUpdate->GetInt() != 0 ? TEXT("on") : TEXT("off"),
+			Bench->NumFrames > 0 ? Bench->GameThreadMs / Bench->NumFrames : 0.0, Bench->NumFrames);
+
+		for (const TWeakObjectPtr<AShooterCharacter>& Character : Bench->Characters)
+		{
+			if (Character.IsValid())
+			{
+				if (AController* Controller = Character->GetController())
+				{
+					Controller->Destroy();
+				}
+				Character->Destroy();
+			}
+		}
+	}
+
+	/**
+	 * Spawns a grid of AI controlled characters that run in circles so their locomotion
+	 * animation is always updating, and logs the average game thread frame time
+	 */
+	static void BenchAnim(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || World->GetNetMode() == NM_Client || ActiveAnimBench.IsValid()) return;
+
+		const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 128;
+		const float Seconds = Args.Num() > 1 ? FMath::Max(1.f, FCString::Atof(*Args[1])) : 10.f;
+
+		const AGameModeBase* GameMode = World->GetAuthGameMode();
+		UClass* CharacterClass = GameMode && GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf<AShooterCharacter>()
+			? GameMode->DefaultPawnClass.Get() : AShooterCharacter::StaticClass();
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+		TSharedPtr<FAnimBench> Bench = MakeShared<FAnimBench>();
+		Bench->World = World;
+
+		const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumCharacters)));
+		for (int32 i = 0; i < NumCharacters; i++)
+		{
+			const FVector Location((i % GridSize - GridSize / 2) * 300.f, (i / GridSize - GridSize / 2) * 300.f, 200.f);
+			AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(CharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+			if (Character)
+			{
+				Character->SpawnDefaultController();
+				Bench->Characters.Add(Character);
+			}
+		}
+
+		Bench->EndTime = FPlatformTime::Seconds() + Seconds;
+		Bench->TickStartHandle = FWorldDelegates::OnWorldTickStart.AddLambda([Bench](UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld != Bench->World.Get()) return;
+
+			// GGameThreadTime is the previous frame's game thread time
+			Bench->GameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+			Bench->NumFrames++;
+
+			// Each character runs its own circle so the locomotion blends keep changing
+			const float Time = TickedWorld->GetTimeSeconds();
+			for (int32 i = 0; i < Bench->Characters.Num(); i++)
+			{
+				if (AShooterCharacter* Character = Bench->Characters[i].Get())
+				{
+					const float Angle = Time + i * 0.7f;
+					Character->AddMovementInput(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f));
+				}
+			}
+
+			if (FPlatformTime::Seconds() >= Bench->EndTime)
+			{
+				FinishAnimBench();
+			}
+		});
+		ActiveAnimBench = Bench;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchAnimCommand(
+		TEXT("Shooter.Bench.Anim"),
+		TEXT("Spawns running characters and logs the average game thread time. Usage: Shooter.Bench.Anim [NumCharacters=128] [Seconds=10]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchAnim));
+
+	/** Logs startup time, memory in use and how many cosmetic assets are loaded, to compare server and game builds */
+	static void ReportFootprint()
+	{
+		int32 NumParticleSystems = 0;
+		for (TObjectIterator<UParticleSystem> It; It; ++It)
+		{
+			NumParticleSystems++;
+		}
+		int32 NumSounds = 0;
+		for (TObjectIterator<USoundBase> It; It; ++It)
+		{
+			NumSounds++;
+		}
+		int32 NumWidgetClasses = 0;
+		for (TObjectIterator<UClass> It; It; ++It)
+		{
+			if (It->IsChildOf(UUserWidget::StaticClass()))
+			{
+				NumWidgetClasses++;
+			}
+		}
+
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		UE_LOG(LogShooter, Display, TEXT("Shooter.Report.Footprint: %s, %.2f s since start, %.1f MB used, %d particle systems, %d sounds, %d widget classes loaded"),
+			IsRunningDedicatedServer() ? TEXT("dedicated server") : TEXT("game"),
+			FPlatformTime::Seconds() - GStartTime, MemoryStats.UsedPhysical / (1024.0 * 1024.0),
+			NumParticleSystems, NumSounds, NumWidgetClasses);
+	}
+
+	static FAutoConsoleCommand ReportFootprintCommand(
+		TEXT("Shooter.Report.Footprint"),
+		TEXT("Logs time since start, memory in use and the number of loaded particle systems, sounds and widget classes"),
+		FConsoleCommandDelegate::CreateStatic(&ReportFootprint));
+
+	/** One scripted character and when it next changes what it's doing */
+	struct FSuiteShooter
+	{
+		TWeakObjectPtr<AShooterCharacter> Character;
+		float NextFireToggleTime = 0.f;
+		float NextPickupTime = 0.f;
+		float NextReloadTime = 0.f;
+		bool bFiring = false;
+	};
+
+	/** A scripted session of characters firing, reloading and swapping weapons in a generated arena */
+	struct FBenchmarkSuite
+	{
+		TWeakObjectPtr<UWorld> World;
+		TArray<FSuiteShooter> Shooters;
+		TArray<TWeakObjectPtr<AWeapon>> SpareWeapons;
+		TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+		int32 NumItems = 0;
+		FRandomStream Random;
+		double StartTime = 0.0;
+		double EndTime = 0.0;
+		double TickStartTime = 0.0;
+		double Seconds = 0.0;
+		bool bQuitWhenDone = false;
+
+		/** Whether the suite started the CSV capture its hot path timings are read from */
+		bool bOwnsCsvCapture = false;
+
+		/** Per frame game thread time and world tick time, in ms */
+		TArray<float> GameThreadMs;
+		TArray<float> WorldTickMs;
+
+		uint64 StartUsedPhysical = 0;
+		uint64 EndUsedPhysical = 0;
+		uint64 PeakUsedPhysical = 0;
+
+		FDelegateHandle TickStartHandle;
+		FDelegateHandle PostActorTickHandle;
+	};
+	static TSharedPtr<FBenchmarkSuite> ActiveSuite;
+
+	/** The report written by the last suite to finish, empty if it couldn't be written */
+	static FString LastSuiteReport;
+
+	/** Average, percentiles and maximum of a set of frame times */
+	static void WriteFrameTimes(TJsonWriter<>& Writer, const TCHAR* Name, TArray<float> FrameMs)
+	{
+		FrameMs.Sort();
+		double Total = 0.0;
+		for (float Ms : FrameMs)
+		{
+			Total += Ms;
+		}
+		auto Percentile = [&FrameMs](float Fraction)
+		{
+			return FrameMs.Num() > 0 ? FrameMs[FMath::Min(FrameMs.Num() - 1, FMath::FloorToInt(FrameMs.Num() * Fraction))] : 0.f;
+		};
+
+		Writer.WriteObjectStart(Name);
+		Writer.WriteValue(TEXT("avg"), FrameMs.Num() > 0 ? Total / FrameMs.Num() : 0.0);
+		Writer.WriteValue(TEXT("p50"), Percentile(0.5f));
+		Writer.WriteValue(TEXT("p95"), Percentile(0.95f));
+		Writer.WriteValue(TEXT("p99"), Percentile(0.99f));
+		Writer.WriteValue(TEXT("max"), FrameMs.Num() > 0 ? FrameMs.Last() : 0.f);
+		Writer.WriteObjectEnd();
+	}
+
+	/**
+	 * Reads the per frame values of the Shooter CSV category out of a CSV profiler capture, keyed by stat name.
+	 * These are the hot path timings in ms and the per frame counts of shots, traces and spawns
+	 */
+	static void ReadShooterCsvStats(const FString& FileName, TMap<FString, TArray<float>>& OutStats)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *FileName) || Lines.Num() < 2) return;
+
+		TArray<FString> Columns;
+		Lines[0].ParseIntoArray(Columns, TEXT(","), false);
+
+		const FString Prefix = TEXT("Shooter/");
+		for (const FString& Column : Columns)
+		{
+			if (Column.StartsWith(Prefix))
+			{
+				OutStats.Add(Column.RightChop(Prefix.Len()));
+			}
+		}
+
+		// Every stat is in the map by now, so the pointers stay valid
+		TArray<TPair<int32, TArray<float>*>> ColumnStats;
+		for (int32 Column = 0; Column < Columns.Num(); Column++)
+		{
+			if (Columns[Column].StartsWith(Prefix))
+			{
+				ColumnStats.Emplace(Column, &OutStats[Columns[Column].RightChop(Prefix.Len())]);
+			}
+		}
+
+		// The header is repeated after the last frame, followed by the capture's metadata
+		TArray<FString> Values;
+		for (int32 LineIndex = 1; LineIndex < Lines.Num() && Lines[LineIndex] != Lines[0] && !Lines[LineIndex].StartsWith(TEXT("[")); LineIndex++)
+		{
+			Lines[LineIndex].ParseIntoArray(Values, TEXT(","), false);
+			for (const TPair<int32, TArray<float>*>& Stat : ColumnStats)
+			{
+				Stat.Value->Add(Values.IsValidIndex(Stat.Key) ? FCString::Atof(*Values[Stat.Key]) : 0.f);
+			}
+		}
+	}
+
+	/** Writes the suite's results to Saved/Benchmarks as JSON, along with the Shooter stats from its CSV capture if it has one */
+	static void WriteSuiteReport(const FBenchmarkSuite& Suite, const FString& CsvFileName)
+	{
+		TMap<FString, TArray<float>> ShooterStats;
+		if (CsvFileName.EndsWith(TEXT(".csv")))
+		{
+			ReadShooterCsvStats(CsvFileName, ShooterStats);
+		}
+		else if (!CsvFileName.IsEmpty())
+		{
+			UE_LOG(LogShooter, Warning, TEXT("Shooter.Bench.Suite: only plain CSV captures are read, so %s isn't in the report"), *CsvFileName);
+		}
+		ShooterStats.KeySort(TLess<FString>());
+
+		const double ToMB = 1.0 / (1024.0 * 1024.0);
+
+		FString Json;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("build"), FString(LexToString(FApp::GetBuildConfiguration())));
+		Writer->WriteValue(TEXT("map"), Suite.World.IsValid() ? Suite.World->GetMapName() : FString());
+		Writer->WriteValue(TEXT("characters"), Suite.Shooters.Num());
+		Writer->WriteValue(TEXT("weapons"), Suite.SpareWeapons.Num());
+		Writer->WriteValue(TEXT("items"), Suite.NumItems);
+		Writer->WriteValue(TEXT("seconds"), Suite.Seconds);
+		Writer->WriteValue(TEXT("frames"), Suite.GameThreadMs.Num());
+		WriteFrameTimes(*Writer, TEXT("gameThreadMs"), Suite.GameThreadMs);
+		WriteFrameTimes(*Writer, TEXT("worldTickMs"), Suite.WorldTickMs);
+		Writer->WriteObjectStart(TEXT("shooterCsv"));
+		for (const TPair<FString, TArray<float>>& Stat : ShooterStats)
+		{
+			WriteFrameTimes(*Writer, *Stat.Key, Stat.Value);
+		}
+		Writer->WriteObjectEnd();
+		Writer->WriteObjectStart(TEXT("memoryMB"));
+		Writer->WriteValue(TEXT("start"), Suite.StartUsedPhysical * ToMB);
+		Writer->WriteValue(TEXT("end"), Suite.EndUsedPhysical * ToMB);
+		Writer->WriteValue(TEXT("peak"), FMath::Max(Suite.PeakUsedPhysical, Suite.EndUsedPhysical) * ToMB);
+		Writer->WriteObjectEnd();
+		Writer->WriteObjectEnd();
+		Writer->Close();
+
+		const FString FileName = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("ShooterBench-%s.json"), *FDateTime::Now().ToString());
+		if (FFileHelper::SaveStringToFile(Json, *FileName))
+		{
+			UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.Suite: wrote %s"), *FileName);
+			LastSuiteReport = FileName;
+		}
+		else
+		{
+			UE_LOG(LogShooter, Error, TEXT("Shooter.Bench.Suite: couldn't write %s"), *FileName);
+			LastSuiteReport.Empty();
+		}
+
+		ActiveSuite.Reset();
+
+		if (Suite.bQuitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+
+	static void FinishBenchmarkSuite()
+	{
+		TSharedPtr<FBenchmarkSuite> Suite = ActiveSuite;
+
+		FWorldDelegates::OnWorldTickStart.Remove(Suite->TickStartHandle);
+		FWorldDelegates::OnWorldPostActorTick.Remove(Suite->PostActorTickHandle);
+
+		Suite->EndUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+		Suite->Seconds = FPlatformTime::Seconds() - Suite->StartTime;
+
+		for (const FSuiteShooter& Shooter : Suite->Shooters)
+		{
+			if (AShooterCharacter* Character = Shooter.Character.Get())
+			{
+				Character->SetFireButtonHeld(false);
+				if (AController* Controller = Character->GetController())
+				{
+					Controller->Destroy();
+				}
+				if (AWeapon* Weapon = Character->GetEquippedWeapon())
+				{
+					Weapon->Destroy();
+				}
+			}
+		}
+		for (const TWeakObjectPtr<AActor>& Actor : Suite->SpawnedActors)
+		{
+			if (Actor.IsValid())
+			{
+				Actor->Destroy();
+			}
+		}
+
+#if CSV_PROFILER
+		if (Suite->bOwnsCsvCapture)
+		{
+			// The capture ends with the frame and is written out on another thread, so the report waits for the file
+			const TSharedFuture<FString> CsvFileName = FCsvProfiler::Get()->EndCapture();
+			FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Suite, CsvFileName](float DeltaTime)
+			{
+				if (!CsvFileName.IsReady()) return true;
+
+				WriteSuiteReport(*Suite, CsvFileName.Get());
+				return false;
+			}));
+			return;
+		}
+#endif
+
+		WriteSuiteReport(*Suite, FString());
+	}
+
+	/** Advances every scripted character: turning, firing in bursts, reloading when empty and swapping to spare weapons */
+	static void TickBenchmarkSuite(FBenchmarkSuite& Suite, float Time)
+	{
+		for (int32 Index = 0; Index < Suite.Shooters.Num(); Index++)
+		{
+			FSuiteShooter& Shooter = Suite.Shooters[Index];
+			AShooterCharacter* Character = Shooter.Character.Get();
+			if (Character == nullptr) continue;
+
+			// Sweep around so shots land on the arena and the other characters. AI controllers set
+			// their control rotation from their focus every tick, so aim through that
+			if (AAIController* Controller = Cast<AAIController>(Character->GetController()))
+			{
+				const FVector AimDirection = FRotator(-5.f, Time * 45.f + Index * 37.f, 0.f).Vector();
+				Controller->SetFocalPoint(Character->GetActorLocation() + AimDirection * 1000.f);
+			}
+
+			if (Time >= Shooter.NextFireToggleTime)
+			{
+				Shooter.bFiring = !Shooter.bFiring;
+				Shooter.NextFireToggleTime = Time + (Shooter.bFiring ? 2.f : 0.5f) + Suite.Random.FRand();
+				Character->SetFireButtonHeld(Shooter.bFiring);
+			}
+
+			// The magazine stays empty until the reload finishes, so only ask again if the last one was refused
+			AWeapon* Weapon = Character->GetEquippedWeapon();
+			if (Weapon && Weapon->GetAmmoCount() == 0 && Time >= Shooter.NextReloadTime)
+			{
+				Shooter.NextReloadTime = Time + 1.f;
+
+				// Never run dry, the session measures reloads not empty clicks
+				Character->GetInventory()->SetAmmo(Weapon->GetAmmoType(), FAmmoInventory::MaxCarriedAmmo);
+				Character->ReloadWeapon();
+			}
+
+			if (Time >= Shooter.NextPickupTime && Suite.SpareWeapons.Num() > 0)
+			{
+				Shooter.NextPickupTime = Time + 5.f + Suite.Random.FRand() * 5.f;
+
+				// Picking up a spare drops the equipped weapon, which becomes a spare for someone else
+				AWeapon* Spare = Suite.SpareWeapons[Suite.Random.RandHelper(Suite.SpareWeapons.Num())].Get();
+				if (Spare && Spare->GetItemState() == EItemState::EIS_Pickup)
+				{
+					if (Weapon)
+					{
+						Suite.SpareWeapons.AddUnique(Weapon);
+						Suite.SpawnedActors.AddUnique(Weapon);
+					}
+
+					Spare->StartItemCurve(Character);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Generates an arena high above the level, fills it with AI characters, spare weapons and items,
+	 * scripts them for a number of seconds and writes frame times, the Shooter CSV stats and memory to
+	 * Saved/Benchmarks as JSON. Runs headless with -nullrhi
+	 */
+	static void BenchSuite(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || World->GetNetMode() == NM_Client || ActiveSuite.IsValid()) return;
+
+		const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 32;
+		const int32 NumWeapons = Args.Num() > 1 ? FMath::Max(0, FCString::Atoi(*Args[1])) : 32;
+		const int32 NumItems = Args.Num() > 2 ? FMath::Max(0, FCString::Atoi(*Args[2])) : 500;
+		const float Seconds = Args.Num() > 3 ? FMath::Max(1.f, FCString::Atof(*Args[3])) : 30.f;
+
+		TSharedPtr<FBenchmarkSuite> Suite = MakeShared<FBenchmarkSuite>();
+		Suite->World = World;
+		Suite->Random.Initialize(1234);
+		Suite->bQuitWhenDone = Args.Contains(TEXT("quit"));
+
+		// A floor well away from the level's own geometry, so results don't depend on the map
+		const FVector ArenaOrigin(0.f, 0.f, 50000.f);
+		const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumCharacters)));
+		const float ArenaExtent = GridSize * 400.f + 2000.f;
+
+		AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(ArenaOrigin, FRotator::ZeroRotator);
+		if (Floor)
+		{
+			Floor->SetMobility(EComponentMobility::Movable);
+			Floor->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+			Floor->SetActorScale3D(FVector(ArenaExtent / 50.f, ArenaExtent / 50.f, 1.f));
+			Suite->SpawnedActors.Add(Floor);
+		}
+
+		const AGameModeBase* GameMode = World->GetAuthGameMode();
+		UClass* CharacterClass = GameMode && GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf<AShooterCharacter>()
+			? GameMode->DefaultPawnClass.Get() : AShooterCharacter::StaticClass();
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+		UClass* WeaponClass = nullptr;
+		for (int32 i = 0; i < NumCharacters; i++)
+		{
+			const FVector Location = ArenaOrigin + FVector((i % GridSize - GridSize / 2) * 400.f, (i / GridSize - GridSize / 2) * 400.f, 200.f);
+			AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(CharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+			if (Character == nullptr) continue;
+
+			Character->SpawnDefaultController();
+			Suite->SpawnedActors.Add(Character);
+
+			FSuiteShooter& Shooter = Suite->Shooters.AddDefaulted_GetRef();
+			Shooter.Character = Character;
+			Shooter.NextFireToggleTime = Suite->Random.FRand();
+			Shooter.NextPickupTime = 2.f + Suite->Random.FRand() * 5.f;
+
+			if (WeaponClass == nullptr && Character->GetEquippedWeapon())
+			{
+				WeaponClass = Character->GetEquippedWeapon()->GetClass();
+			}
+		}
+
+		// Spare weapons scattered across the arena to be picked up
+		if (WeaponClass)
+		{
+			for (int32 i = 0; i < NumWeapons; i++)
+			{
+				const FVector Location = ArenaOrigin + FVector(Suite->Random.FRandRange(-1.f, 1.f) * ArenaExtent * 0.8f, Suite->Random.FRandRange(-1.f, 1.f) * ArenaExtent * 0.8f, 100.f);
+				AWeapon* Weapon = World->SpawnActor<AWeapon>(WeaponClass, Location, FRotator::ZeroRotator, SpawnParams);
+				if (Weapon)
+				{
+					Suite->SpareWeapons.Add(Weapon);
+					Suite->SpawnedActors.Add(Weapon);
+				}
+			}
+		}
+
+		TArray<AItem*> Items;
+		SpawnItemCopies(World, NumItems, ArenaExtent * 0.8f, Items, ArenaOrigin);
+		for (AItem* Item : Items)
+		{
+			Suite->SpawnedActors.Add(Item);
+		}
+		Suite->NumItems = Items.Num();
+
+		Suite->StartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+		Suite->PeakUsedPhysical = Suite->StartUsedPhysical;
+		Suite->StartTime = FPlatformTime::Seconds();
+		Suite->EndTime = Suite->StartTime + Seconds;
+		Suite->GameThreadMs.Reserve(FMath::CeilToInt(Seconds * 120.f));
+		Suite->WorldTickMs.Reserve(FMath::CeilToInt(Seconds * 120.f));
+
+#if CSV_PROFILER
+		// Hot path timings come from the Shooter CSV category. A capture that's already running is left alone
+		if (!FCsvProfiler::Get()->IsCapturing())
+		{
+			FCsvProfiler::Get()->BeginCapture();
+			Suite->bOwnsCsvCapture = true;
+		}
+#endif
+
+		const float WorldStartTime = World->GetTimeSeconds();
+		Suite->TickStartHandle = FWorldDelegates::OnWorldTickStart.AddLambda([Suite, WorldStartTime](UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld != Suite->World.Get()) return;
+
+			if (FPlatformTime::Seconds() >= Suite->EndTime)
+			{
+				FinishBenchmarkSuite();
+				return;
+			}
+
+			// GGameThreadTime is the previous frame's game thread time
+			if (Suite->TickStartTime > 0.0)
+			{
+				Suite->GameThreadMs.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+			}
+
+			// Reading memory stats isn't free, so only sample a few times a second
+			if (GFrameCounter % 30 == 0)
+			{
+				Suite->PeakUsedPhysical = FMath::Max<uint64>(Suite->PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+			}
+
+			TickBenchmarkSuite(*Suite, TickedWorld->GetTimeSeconds() - WorldStartTime);
+			Suite->TickStartTime = FPlatformTime::Seconds();
+		});
+		Suite->PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([Suite](UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld == Suite->World.Get() && Suite->TickStartTime > 0.0)
+			{
+				Suite->WorldTickMs.Add((FPlatformTime::Seconds() - Suite->TickStartTime) * 1000.0);
+			}
+		});
+		ActiveSuite = Suite;
+
+		UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.Suite: %d characters, %d spare weapons, %d items for %.0f seconds"),
+			Suite->Shooters.Num(), Suite->SpareWeapons.Num(), Suite->NumItems, Seconds);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchSuiteCommand(
+		TEXT("Shooter.Bench.Suite"),
+		TEXT("Scripts characters firing, reloading and swapping weapons in a generated arena and writes the results to Saved/Benchmarks as JSON. Usage: Shooter.Bench.Suite [Characters=32] [Weapons=32] [Items=500] [Seconds=30] [quit]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchSuite));
+
+	/** Keeps a fixed number of rounds in flight while the projectile subsystem's cost is measured */
+	struct FProjectileBench
+	{
+		TWeakObjectPtr<UWorld> World;
+		int32 NumRounds = 0;
+		FRandomStream Random;
+		double EndTime = 0.0;
+		int64 RoundsSimulated = 0;
+		double SimulateSeconds = 0.0;
+		int32 NumFrames = 0;
+		FDelegateHandle TickStartHandle;
+	};
+	static TSharedPtr<FProjectileBench> ActiveProjectileBench;
+
+	static void FinishProjectileBench()
+	{
+		TSharedPtr<FProjectileBench> Bench = ActiveProjectileBench;
+		ActiveProjectileBench.Reset();
+
+		FWorldDelegates::OnWorldTickStart.Remove(Bench->TickStartHandle);
+
+		const double SimulateMs = Bench->SimulateSeconds * 1000.0;
+		UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.Projectiles: %d rounds in flight, %.3f ms average projectile tick over %d frames, %.0f rounds per ms"),
+			Bench->NumRounds, Bench->NumFrames > 0 ? SimulateMs / Bench->NumFrames : 0.0, Bench->NumFrames,
+			SimulateMs > 0.0 ? Bench->RoundsSimulated / SimulateMs : 0.0);
+
+		if (UWorld* World = Bench->World.Get())
+		{
+			if (UShooterProjectileSubsystem* Projectiles = World->GetSubsystem<UShooterProjectileSubsystem>())
+			{
+				Projectiles->ClearProjectiles();
+			}
+		}
+	}
+
+	/**
+	 * Fires rounds in every direction from above the middle of the map, topping them up each frame,
+	 * and logs how many rounds the projectile subsystem integrates and sweeps per millisecond
+	 */
+	static void BenchProjectiles(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || ActiveProjectileBench.IsValid()) return;
+
+		UShooterProjectileSubsystem* Projectiles = World->GetSubsystem<UShooterProjectileSubsystem>();
+		if (Projectiles == nullptr) return;
+
+		TSharedPtr<FProjectileBench> Bench = MakeShared<FProjectileBench>();
+		Bench->World = World;
+		Bench->NumRounds = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+		Bench->Random.Initialize(0x5E7B0B);
+		const float Seconds = Args.Num() > 1 ? FMath::Max(1.f, FCString::Atof(*Args[1])) : 10.f;
+
+		IConsoleVariable* MaxProjectiles = IConsoleManager::Get().FindConsoleVariable(TEXT("Shooter.Projectiles.Max"));
+		if (MaxProjectiles && MaxProjectiles->GetInt() < Bench->NumRounds)
+		{
+			MaxProjectiles->Set(Bench->NumRounds);
+		}
+
+		Projectiles->ClearProjectiles();
+
+		Bench->EndTime = FPlatformTime::Seconds() + Seconds;
+		Bench->TickStartHandle = FWorldDelegates::OnWorldTickStart.AddLambda([Bench](UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld != Bench->World.Get()) return;
+
+			UShooterProjectileSubsystem* Projectiles = TickedWorld->GetSubsystem<UShooterProjectileSubsystem>();
+			if (Projectiles == nullptr) return;
+
+			// The subsystem ticks after the world, so its numbers are from the previous frame
+			if (Projectiles->GetLastTickProjectiles() > 0)
+			{
+				Bench->RoundsSimulated += Projectiles->GetLastTickProjectiles();
+				Bench->SimulateSeconds += Projectiles->GetLastTickSeconds();
+				Bench->NumFrames++;
+			}
+
+			// Replace rounds that hit something or expired. Those fired downwards hit the map, the rest fly off
+			const FVector Origin(0.f, 0.f, 20000.f);
+			for (int32 i = Projectiles->GetNumProjectiles(); i < Bench->NumRounds; i++)
+			{
+				const FVector Velocity = Bench->Random.VRand() * Bench->Random.FRandRange(20000.f, 60000.f);
+				Projectiles->LaunchProjectile(Origin, Velocity, 0.00001f, Bench->Random.FRandRange(1.f, 3.f), nullptr, nullptr, DeltaSeconds);
+			}
+
+			if (FPlatformTime::Seconds() >= Bench->EndTime)
+			{
+				FinishProjectileBench();
+			}
+		});
+		ActiveProjectileBench = Bench;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchProjectilesCommand(
+		TEXT("Shooter.Bench.Projectiles"),
+		TEXT("Keeps ballistic rounds in flight and logs rounds simulated per ms. Usage: Shooter.Bench.Projectiles [Rounds=10000] [Seconds=10]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchProjectiles));
+
+	/** One character holding the trigger while its shots are counted against the weapon's fire rate */
+	struct FFireRateBench
+	{
+		TWeakObjectPtr<UWorld> World;
+		TWeakObjectPtr<AShooterCharacter> Character;
+		double EndTime = 0.0;
+		double SimulatedSeconds = 0.0;
+		int32 NumShots = 0;
+		int32 NumFrames = 0;
+		bool bFiring = false;
+
+		/** Tap fire: how long each tap holds the trigger and the pause after it, zero to hold throughout */
+		float TapSeconds = 0.f;
+		float PhaseSeconds = 0.f;
+		bool bTriggerHeld = false;
+		int32 NumTaps = 0;
+
+		FDelegateHandle TickStartHandle;
+	};
+	static TSharedPtr<FFireRateBench> ActiveFireRateBench;
+
+	static void FinishFireRateBench()
+	{
+		TSharedPtr<FFireRateBench> Bench = ActiveFireRateBench;
+		ActiveFireRateBench.Reset();
+
+		FWorldDelegates::OnWorldTickStart.Remove(Bench->TickStartHandle);
+
+		AShooterCharacter* Character = Bench->Character.Get();
+		const AWeapon* Weapon = Character ? Character->GetEquippedWeapon() : nullptr;
+		const float FireRate = Weapon && Weapon->GetWeaponDefinition() ? Weapon->GetWeaponDefinition()->GetAutomaticFireRate() : 0.f;
+		const double FrameRate = Bench->SimulatedSeconds > 0.0 ? Bench->NumFrames / Bench->SimulatedSeconds : 0.0;
+		if (Bench->TapSeconds > 0.f)
+		{
+			// A tap fires on press and then every FireRate while held, however the frames fall
+			UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.FireRate: %.1f Hz, %d taps of %.3f s, %.2f shots per tap, expected %d"),
+				FrameRate, Bench->NumTaps, Bench->TapSeconds, Bench->NumTaps > 0 ? static_cast<double>(Bench->NumShots) / Bench->NumTaps : 0.0,
+				FireRate > 0.f ? FMath::CeilToInt(Bench->TapSeconds / FireRate - KINDA_SMALL_NUMBER) : 0);
+		}
+		else
+		{
+			UE_LOG(LogShooter, Display, TEXT("Shooter.Bench.FireRate: %.1f Hz, %d shots in %.2f s, %.1f rounds per minute, weapon rate %.1f"),
+				FrameRate, Bench->NumShots, Bench->SimulatedSeconds,
+				Bench->SimulatedSeconds > 0.0 ? Bench->NumShots * 60.0 / Bench->SimulatedSeconds : 0.0, FireRate > 0.f ? 60.f / FireRate : 0.f);
+		}
+
+		if (Character)
+		{
+			if (AController* Controller = Character->GetController())
+			{
+				Controller->Destroy();
+			}
+			Character->Destroy();
+		}
+	}
+
+	/**
+	 * Spawns a character that holds the trigger with a magazine kept topped up, and logs the rounds per
+	 * minute it fires. With TapSeconds it taps the trigger instead, holding and pausing for that long each
+	 * time, and logs the shots per tap. Run at different frame rates, e.g. with -benchmark -fps=30, to check they match
+	 */
+	static void BenchFireRate(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || World->GetNetMode() == NM_Client || ActiveFireRateBench.IsValid()) return;
+
+		const float Seconds = Args.Num() > 0 ? FMath::Max(1.f, FCString::Atof(*Args[0])) : 10.f;
+		const float TapSeconds = Args.Num() > 1 ? FMath::Max(0.f, FCString::Atof(*Args[1])) : 0.f;
+
+		const AGameModeBase* GameMode = World->GetAuthGameMode();
+		UClass* CharacterClass = GameMode && GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf<AShooterCharacter>()
+			? GameMode->DefaultPawnClass.Get() : AShooterCharacter::StaticClass();
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+		AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(CharacterClass, FVector(0.f, 0.f, 200.f), FRotator::ZeroRotator, SpawnParams);
+		if (Character == nullptr) return;
+		Character->SpawnDefaultController();
+
+		TSharedPtr<FFireRateBench> Bench = MakeShared<FFireRateBench>();
+		Bench->World = World;
+		Bench->Character = Character;
+		Bench->TapSeconds = TapSeconds;
+		Bench->EndTime = FPlatformTime::Seconds() + Seconds;
+		Bench->TickStartHandle = FWorldDelegates::OnWorldTickStart.AddLambda([Bench](UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds)
+		{
+			if (TickedWorld != Bench->World.Get()) return;
+
+			AShooterCharacter* Character = Bench->Character.Get();
+			AWeapon* Weapon = Character ? Character->GetEquippedWeapon() : nullptr;
+			if (Weapon == nullptr)
+			{
+				FinishFireRateBench();
+				return;
+			}
+
+			// Whatever is missing from the magazine was fired since the last frame started
+			const int32 Fired = Weapon->GetMagazineCapacity() - Weapon->GetAmmoCount();
+			if (Bench->bFiring)
+			{
+				Bench->NumShots += Fired;
+				Bench->SimulatedSeconds += DeltaSeconds;
+				Bench->NumFrames++;
+				Bench->PhaseSeconds += DeltaSeconds;
+			}
+			else
+			{
+				Bench->bFiring = true;
+				Bench->bTriggerHeld = true;
+				Bench->NumTaps++;
+				Character->SetFireButtonHeld(true);
+			}
+			Weapon->ReloadAmmo(Fired);
+
+			const bool bTimeUp = FPlatformTime::Seconds() >= Bench->EndTime;
+			if (Bench->TapSeconds > 0.f && Bench->PhaseSeconds >= Bench->TapSeconds - KINDA_SMALL_NUMBER)
+			{
+				// Only finish after a release, so every tap counted has fired all its shots
+				Bench->PhaseSeconds = 0.f;
+				Bench->bTriggerHeld = !Bench->bTriggerHeld;
+				if (!Bench->bTriggerHeld && bTimeUp)
+				{
+					Character->SetFireButtonHeld(false);
+					FinishFireRateBench();
+					return;
+				}
+				if (Bench->bTriggerHeld)
+				{
+					Bench->NumTaps++;
+				}
+				Character->SetFireButtonHeld(Bench->bTriggerHeld);
+			}
+			else if (Bench->TapSeconds <= 0.f && bTimeUp)
+			{
+				FinishFireRateBench();
+			}
+		});
+		ActiveFireRateBench = Bench;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchFireRateCommand(
+		TEXT("Shooter.Bench.FireRate"),
+		TEXT("Holds or taps the trigger on a character with endless ammo and logs the rounds fired. Usage: Shooter.Bench.FireRate [Seconds=10] [TapSeconds=0]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchFireRate));
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Starts the benchmark suite in the game world and waits for its report */
+class FShooterRunBenchmarkSuiteCommand : public IAutomationLatentCommand
+{
+public:
+	FShooterRunBenchmarkSuiteCommand(FAutomationTestBase* InTest, const TArray<FString>& InArgs)
+		: Test(InTest)
+		, Args(InArgs)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		if (!bStarted)
+		{
+			bStarted = true;
+
+			UWorld* World = nullptr;
+			for (const FWorldContext& Context : GEngine->GetWorldContexts())
+			{
+				if (Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE)
+				{
+					World = Context.World();
+					break;
+				}
+			}
+			if (!Test->TestNotNull(TEXT("Game world"), World)) return true;
+
+			ShooterBenchmarks::LastSuiteReport.Empty();
+			ShooterBenchmarks::BenchSuite(Args, World);
+			return false;
+		}
+
+		if (ShooterBenchmarks::ActiveSuite.IsValid()) return false;
+
+		Test->TestFalse(TEXT("Benchmark suite wrote its report"), ShooterBenchmarks::LastSuiteReport.IsEmpty());
+		return true;
+	}
+
+private:
+	FAutomationTestBase* Test;
+	TArray<FString> Args;
+	bool bStarted = false;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShooterBenchmarkSuiteTest, "Shooter.Benchmarks.Suite", EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+/** Runs Shooter.Bench.Suite on the default map with its default arguments */
+bool FShooterBenchmarkSuiteTest::RunTest(const FString& Parameters)
+{
+	AutomationOpenMap(TEXT("/Game/_Game/Maps/DefaultMap"));
+	ADD_LATENT_AUTOMATION_COMMAND(FShooterRunBenchmarkSuiteCommand(this, TArray<FString>()));
+	return true;
+}
+
+#endif
@@ -0,0 +1,272 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterBotController.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "ShooterCharacter.h"
+#include "ShooterInventoryComponent.h"
+#include "ItemSpatialSubsystem.h"
+#include "ShooterSignificanceSubsystem.h"
+#include "Weapon.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Think"), STAT_BotThink, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot Thinks"), STAT_BotThinks, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bots"), STAT_Bots, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarBotsInfiniteAmmo(
+	TEXT("Shooter.Bots.InfiniteAmmo"),
+	0,
+	TEXT("If non-zero, bots get their carried ammo topped up when they reload, so soak tests keep firing without going for pickups."),
+	ECVF_Default);
+
+AShooterBotController::AShooterBotController() :
+	ThinkInterval(0.5f),
+	EngageRange(4000.f),
+	AimError(40.f),
+	PickupSearchRadius(2000.f),
+	PickupSelectDistance(200.f),
+	NextThinkTime(0.f),
+	MoveDirection(FVector::ZeroVector),
+	bFiring(false)
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Bots are spawned for testing and don't need to show up in the scoreboard
+	bWantsPlayerState = false;
+}
+
+void AShooterBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	ShooterCharacter = Cast<AShooterCharacter>(InPawn);
+
+	// Spread the bots' decisions across frames
+	NextThinkTime = GetWorld()->GetTimeSeconds() + FMath::FRand() * ThinkInterval;
+	INC_DWORD_STAT(STAT_Bots);
+}
+
+void AShooterBotController::OnUnPossess()
+{
+	if (ShooterCharacter)
+	{
+		ShooterCharacter->SetFireButtonHeld(false);
+		DEC_DWORD_STAT(STAT_Bots);
+	}
+	ShooterCharacter = nullptr;
+
+	Super::OnUnPossess();
+}
+
+void AShooterBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (ShooterCharacter == nullptr) return;
+
+	if (GetWorld()->GetTimeSeconds() >= NextThinkTime)
+	{
+		NextThinkTime = GetWorld()->GetTimeSeconds() + ThinkInterval;
+		Think();
+	}
+
+	if (!MoveDirection.IsZero())
+	{
+		ShooterCharacter->AddMovementInput(MoveDirection);
+	}
+}
+
+void AShooterBotController::Think()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BotThink);
+	CSV_SCOPED_TIMING_STAT(Shooter, BotThink);
+	INC_DWORD_STAT(STAT_BotThinks);
+
+	const FVector Location = ShooterCharacter->GetActorLocation();
+	const AWeapon* Weapon = ShooterCharacter->GetEquippedWeapon();
+	const bool bMagazineEmpty = Weapon == nullptr || Weapon->GetAmmoCount() == 0;
+
+	if (Weapon && bMagazineEmpty)
+	{
+		if (CVarBotsInfiniteAmmo.GetValueOnGameThread() != 0)
+		{
+			ShooterCharacter->GetInventory()->SetAmmo(Weapon->GetAmmoType(), FAmmoInventory::MaxCarriedAmmo);
+		}
+		ShooterCharacter->ReloadButtonPressed();
+	}
+
+	// Out of ammo altogether, go and find another gun
+	const bool bNeedsWeapon = bMagazineEmpty && (Weapon == nullptr || ShooterCharacter->GetInventory()->GetAmmo(Weapon->GetAmmoType()) == 0);
+	if (bNeedsWeapon)
+	{
+		if (bFiring)
+		{
+			bFiring = false;
+			ShooterCharacter->SetFireButtonHeld(false);
+		}
+
+		if (AItem* Pickup = FindClosestPickup())
+		{
+			const FVector ToPickup = Pickup->GetActorLocation() - Location;
+			if (ToPickup.SizeSquared2D() < FMath::Square(PickupSelectDistance))
+			{
+				ShooterCharacter->SelectItem(Pickup);
+				MoveDirection = FVector::ZeroVector;
+			}
+			else
+			{
+				MoveDirection = ToPickup.GetSafeNormal2D();
+				SetFocalPoint(Pickup->GetActorLocation());
+			}
+			return;
+		}
+	}
+
+	AShooterCharacter* Enemy = FindClosestEnemy();
+	const bool bShouldFire = Enemy && !bNeedsWeapon && LineOfSightTo(Enemy);
+	if (bShouldFire)
+	{
+		// Strafe while shooting, closing in if the target is near the edge of range
+		const FVector ToEnemy = Enemy->GetActorLocation() - Location;
+		const FVector Strafe = FVector::CrossProduct(ToEnemy.GetSafeNormal2D(), FVector::UpVector) * (FMath::RandBool() ? 1.f : -1.f);
+		MoveDirection = ToEnemy.SizeSquared() > FMath::Square(EngageRange * 0.75f) ? (Strafe + ToEnemy.GetSafeNormal2D()).GetSafeNormal() : Strafe;
+		SetFocalPoint(Enemy->GetActorLocation() + FMath::VRand() * AimError);
+	}
+	else
+	{
+		// Wander, looking where we're going
+		const float Yaw = FMath::FRand() * 360.f;
+		MoveDirection = FRotator(0.f, Yaw, 0.f).Vector();
+		SetFocalPoint(Location + MoveDirection * 1000.f);
+	}
+
+	if (bShouldFire != bFiring)
+	{
+		bFiring = bShouldFire;
+		ShooterCharacter->SetFireButtonHeld(bFiring);
+	}
+}
+
+AShooterCharacter* AShooterBotController::FindClosestEnemy() const
+{
+	// Every character registers with the significance subsystem, so its list saves iterating the world's actors
+	const UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>();
+	if (SignificanceSubsystem == nullptr) return nullptr;
+
+	const FVector Location = ShooterCharacter->GetActorLocation();
+	float ClosestDistSquared = FMath::Square(EngageRange);
+	AShooterCharacter* Closest = nullptr;
+	for (AShooterCharacter* Character : SignificanceSubsystem->GetCharacters())
+	{
+		if (Character == ShooterCharacter || Character == nullptr) continue;
+
+		const float DistSquared = FVector::DistSquared(Location, Character->GetActorLocation());
+		if (DistSquared < ClosestDistSquared)
+		{
+			ClosestDistSquared = DistSquared;
+			Closest = Character;
+		}
+	}
+	return Closest;
+}
+
+AItem* AShooterBotController::FindClosestPickup() const
+{
+	const UItemSpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UItemSpatialSubsystem>();
+	if (SpatialSubsystem == nullptr) return nullptr;
+
+	const FVector Location = ShooterCharacter->GetActorLocation();
+	TArray<AItem*> Items;
+	SpatialSubsystem->QueryItems(Location, PickupSearchRadius, Items);
+
+	float ClosestDistSquared = MAX_flt;
+	AItem* Closest = nullptr;
+	for (AItem* Item : Items)
+	{
+		// Skip empty guns, including the one we just dropped
+		const AWeapon* Weapon = Cast<AWeapon>(Item);
+		if (Weapon == nullptr || Weapon->GetAmmoCount() == 0) continue;
+
+		const float DistSquared = FVector::DistSquared(Location, Item->GetActorLocation());
+		if (DistSquared < ClosestDistSquared)
+		{
+			ClosestDistSquared = DistSquared;
+			Closest = Item;
+		}
+	}
+	return Closest;
+}
+
+namespace ShooterBots
+{
+	/** Spawns bot-controlled characters at the level's player starts */
+	static void SpawnBots(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr || World->GetNetMode() == NM_Client) return;
+
+		const int32 NumBots = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 16;
+
+		const AGameModeBase* GameMode = World->GetAuthGameMode();
+		UClass* CharacterClass = GameMode && GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf<AShooterCharacter>()
+			? GameMode->DefaultPawnClass.Get() : AShooterCharacter::StaticClass();
+
+		TArray<FVector> StartLocations;
+		for (TActorIterator<APlayerStart> It(World); It; ++It)
+		{
+			StartLocations.Add(It->GetActorLocation());
+		}
+		if (StartLocations.Num() == 0)
+		{
+			StartLocations.Add(FVector(0.f, 0.f, 200.f));
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+		int32 NumSpawned = 0;
+		for (int32 i = 0; i < NumBots; i++)
+		{
+			const FVector Location = StartLocations[i % StartLocations.Num()] + FVector(FMath::FRandRange(-1000.f, 1000.f), FMath::FRandRange(-1000.f, 1000.f), 0.f);
+			AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(CharacterClass, Location, FRotator(0.f, FMath::FRand() * 360.f, 0.f), SpawnParams);
+			if (Character == nullptr) continue;
+
+			AShooterBotController* Bot = World->SpawnActor<AShooterBotController>(Location, Character->GetActorRotation());
+			if (Bot)
+			{
+				Bot->Possess(Character);
+				NumSpawned++;
+			}
+		}
+
+		UE_LOG(LogShooter, Display, TEXT("Shooter.SpawnBots: spawned %d bots"), NumSpawned);
+	}
+
+	/** Destroys every bot and the character it controls */
+	static void RemoveBots(UWorld* World)
+	{
+		if (World == nullptr) return;
+
+		for (TActorIterator<AShooterBotController> It(World); It; ++It)
+		{
+			if (APawn* Pawn = It->GetPawn())
+			{
+				Pawn->Destroy();
+			}
+			It->Destroy();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs SpawnBotsCommand(
+		TEXT("Shooter.SpawnBots"),
+		TEXT("Server only. Spawns bot-controlled characters around the player starts. Usage: Shooter.SpawnBots [NumBots=16]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SpawnBots));
+
+	static FAutoConsoleCommandWithWorld RemoveBotsCommand(
+		TEXT("Shooter.RemoveBots"),
+		TEXT("Destroys every bot and its character."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&RemoveBots));
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "ShooterBotController.generated.h"
+
+class AShooterCharacter;
+class AItem;
+
+/**
+ * Drives an AShooterCharacter through the same fire, reload and select paths a player uses, for
+ * load and soak testing. Decisions are made a few times a second, staggered between bots, and
+ * only the cached movement input is applied every frame, so hundreds of bots stay cheap.
+ */
+UCLASS()
+class SHOOTER_API AShooterBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AShooterBotController();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+
+private:
+	/** Picks a target or a pickup and decides how to move, aim and fire until the next think */
+	void Think();
+
+	/** Closest other character within EngageRange, or nullptr */
+	AShooterCharacter* FindClosestEnemy() const;
+
+	/** Closest weapon lying on the ground within PickupSearchRadius, or nullptr */
+	AItem* FindClosestPickup() const;
+
+	UPROPERTY()
+	AShooterCharacter* ShooterCharacter;
+
+	/** Seconds between decisions */
+	UPROPERTY(EditDefaultsOnly, Category = "Bot", meta = (AllowPrivateAccess = "true"))
+	float ThinkInterval;
+
+	/** Furthest away an enemy can be and still be shot at */
+	UPROPERTY(EditDefaultsOnly, Category = "Bot", meta = (AllowPrivateAccess = "true"))
+	float EngageRange;
+
+	/** Random aim offset at the target, in units */
+	UPROPERTY(EditDefaultsOnly, Category = "Bot", meta = (AllowPrivateAccess = "true"))
+	float AimError;
+
+	/** How far to look for a weapon to pick up once out of ammo */
+	UPROPERTY(EditDefaultsOnly, Category = "Bot", meta = (AllowPrivateAccess = "true"))
+	float PickupSearchRadius;
+
+	/** Close enough to a pickup to select it */
+	UPROPERTY(EditDefaultsOnly, Category = "Bot", meta = (AllowPrivateAccess = "true"))
+	float PickupSelectDistance;
+
+	/** World time of the next decision */
+	float NextThinkTime;
+
+	/** Movement input applied every frame until the next think */
+	FVector MoveDirection;
+
+	bool bFiring;
+};
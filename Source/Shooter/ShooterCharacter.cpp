@@ -11,10 +11,74 @@
 #include "DrawDebugHelpers.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Item.h"
-#include "Components/WidgetComponent.h"
-#include "Components/SphereComponent.h"
 #include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
 #include "Weapon.h"
+#include "ShooterInventoryComponent.h"
+#include "ShooterFireBurstComponent.h"
+#include "ShooterLagCompensationComponent.h"
+#include "ShooterHitscanSubsystem.h"
+#include "ShooterProjectileSubsystem.h"
+#include "ShooterEmitterPoolSubsystem.h"
+#include "ItemSpatialSubsystem.h"
+#include "ShooterPlayerController.h"
+#include "ShooterSignificanceSubsystem.h"
+#include "ShooterInputReplaySubsystem.h"
+#include "GameFramework/PlayerInput.h"
+#include "Net/UnrealNetwork.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair Traces"), STAT_CrosshairTraces, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crosshair Queries Saved"), STAT_CrosshairQueriesSaved, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Character Tick"), STAT_CharacterTick, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Crosshair Trace"), STAT_CrosshairTrace, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Trace For Items"), STAT_TraceForItems, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Send Bullet"), STAT_SendBullet, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Finish Reloading"), STAT_FinishReloading, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bullets Sent"), STAT_BulletsSent, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarHUDCrosshairSpreadTolerance(
+	TEXT("Shooter.HUD.CrosshairSpreadTolerance"),
+	0.01f,
+	TEXT("How far the crosshair spread has to move before the HUD is told about it."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMaxShotsPerFrame(
+	TEXT("Shooter.Fire.MaxShotsPerFrame"),
+	32,
+	TEXT("Most automatic shots one character fires in a frame. Shots owed beyond this after a hitch are dropped."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarUROMediumFrameSkip(
+	TEXT("Shooter.URO.MediumFrameSkip"),
+	1,
+	TEXT("Frames skipped between anim evaluations for Medium significance characters. Skipped frames are interpolated."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarUROLowFrameSkip(
+	TEXT("Shooter.URO.LowFrameSkip"),
+	3,
+	TEXT("Frames skipped between anim evaluations for Low significance characters. Skipped frames are interpolated."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarURONonRenderedUpdateRate(
+	TEXT("Shooter.URO.NonRenderedUpdateRate"),
+	8,
+	TEXT("Anim update rate for character meshes that are off screen on clients and listen servers."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAsyncItemTrace(
+	TEXT("Shooter.AsyncItemTrace"),
+	0,
+	TEXT("If non-zero, item tracing uses the async trace API and applies the result one frame late.\n")
+	TEXT("0: blocking line trace on the game thread (default)\n")
+	TEXT("1: async line trace, result used next frame"),
+	ECVF_Default);
+
+/** Distance a character can have moved between tracing for an item and the server receiving the pickup, cm */
+static const float PickupReachTolerance = 150.f;
+
+FOnShooterCharacterEquipWeapon AShooterCharacter::NotifyEquipWeapon;
 
 // Sets default values
 AShooterCharacter::AShooterCharacter() :
@@ -40,6 +104,7 @@ AShooterCharacter::AShooterCharacter() :
 	ZoomInterpSpeed(20.f),
 	// Crosshair spread factors
 	CrosshairSpreadMultiplier(0.f),
+	BroadcastCrosshairSpread(0.f),
 	CrosshairVelocityFactor(0.f),
 	CrosshairInAirFactor(0.f),
 	CrosshairAimFactor(0.f),
@@ -48,8 +113,11 @@ AShooterCharacter::AShooterCharacter() :
 	ShootTimeDuration(0.05f),
 	bFiringBullet(false),
 	// Automatic firing variables
-	AutomaticFireRate(0.1f),
 	bFireButtonPressed(false),
+	FireCooldown(0.f),
+	FireTimerStartFrame(0),
+	LastShotCosmeticsFrame(0),
+	bServerReloadPending(false),
 	// Item trace variables
 	bShouldTraceForItems(false),
 	CameraInterpDistance(250.f),
@@ -58,7 +126,11 @@ AShooterCharacter::AShooterCharacter() :
 	Starting9mmAmmo(60),
 	StartingARAmmo(90),
 	// Combat variables
-	CombatState(ECombatState::ECS_Unoccupied)
+	CombatState(ECombatState::ECS_Unoccupied),
+	// Crosshair trace variables
+	CrosshairTraceLength(50000.f),
+	// Ticks every frame until scored
+	Significance(EShooterSignificance::ESS_High)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -79,6 +151,10 @@ AShooterCharacter::AShooterCharacter() :
 	bUseControllerRotationYaw = true;
 	bUseControllerRotationRoll = false;
 
+	// Skip and interpolate anim updates according to significance
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+	GetMesh()->OnAnimUpdateRateParamsCreated.BindUObject(this, &AShooterCharacter::OnAnimUpdateRateParamsCreated);
+
 	// Configure character movement
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 	GetCharacterMovement()->RotationRate = FRotator(0.f, 540.f, 0.f);
@@ -87,6 +163,15 @@ AShooterCharacter::AShooterCharacter() :
 
 	// Create HandSceneComponent
 	HandSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("HandSceneComponent"));
+
+	// Create Inventory
+	Inventory = CreateDefaultSubobject<UShooterInventoryComponent>(TEXT("Inventory"));
+
+	// Create FireBurst
+	FireBurst = CreateDefaultSubobject<UShooterFireBurstComponent>(TEXT("FireBurst"));
+
+	// Create LagCompensation
+	LagCompensation = CreateDefaultSubobject<UShooterLagCompensationComponent>(TEXT("LagCompensation"));
 }
 
 // Called when the game starts or when spawned
@@ -99,8 +184,95 @@ void AShooterCharacter::BeginPlay()
 		CameraDefaultFOV = GetFollowCamera()->FieldOfView;
 		CameraCurrentFOV = CameraDefaultFOV;
 	}
-	EquipWeapon(SpawnDefaultWeapon());
-	InitialiseAmmoMap();
+	// Weapons replicate, so only the server spawns them
+	if (HasAuthority())
+	{
+		EquipWeapon(SpawnDefaultWeapon());
+	}
+	Inventory->OnAmmoChanged.AddUObject(this, &AShooterCharacter::HandleInventoryAmmoChanged);
+	InitialiseAmmo();
+
+	UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>();
+	if (SignificanceSubsystem)
+	{
+		SignificanceSubsystem->Register(this);
+	}
+}
+
+void AShooterCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UShooterSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<UShooterSignificanceSubsystem>();
+	if (SignificanceSubsystem)
+	{
+		SignificanceSubsystem->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AShooterCharacter::SetSignificance(EShooterSignificance NewSignificance, float TickInterval)
+{
+	if (Significance != NewSignificance)
+	{
+		Significance = NewSignificance;
+		ApplyAnimUpdateRate(GetMesh()->AnimUpdateRateParams);
+	}
+	if (GetActorTickInterval() != TickInterval)
+	{
+		SetActorTickInterval(TickInterval);
+	}
+}
+
+void AShooterCharacter::OnAnimUpdateRateParamsCreated(FAnimUpdateRateParameters* Params)
+{
+	// Rates come from our significance tiers rather than the engine's screen size thresholds
+	Params->bShouldUseLodMap = true;
+	ApplyAnimUpdateRate(Params);
+}
+
+void AShooterCharacter::ApplyAnimUpdateRate(FAnimUpdateRateParameters* Params) const
+{
+	if (Params == nullptr) return;
+
+	int32 FrameSkip = 0;
+	if (CombatState != ECombatState::ECS_Reloading)
+	{
+		if (Significance == EShooterSignificance::ESS_Medium)
+		{
+			FrameSkip = FMath::Max(0, CVarUROMediumFrameSkip.GetValueOnGameThread());
+		}
+		else if (Significance == EShooterSignificance::ESS_Low)
+		{
+			FrameSkip = FMath::Max(0, CVarUROLowFrameSkip.GetValueOnGameThread());
+		}
+	}
+
+	// Every LOD skips the same number of frames, the tier decides it
+	Params->LODToFrameSkipMap.Reset();
+	for (int32 LODIndex = 0; LODIndex < MAX_SKELETAL_MESH_LODS; LODIndex++)
+	{
+		Params->LODToFrameSkipMap.Add(LODIndex, FrameSkip);
+	}
+
+	// Skipped frames are only interpolated below this evaluation rate, which defaults to 4, i.e. a frame skip of 3
+	Params->MaxEvalRateForInterpolation = FMath::Max(4, FrameSkip + 2);
+
+	// Nothing is rendered on a dedicated server, but lag compensation still needs poses near players
+	if (IsNetMode(NM_DedicatedServer) || CombatState == ECombatState::ECS_Reloading)
+	{
+		Params->BaseNonRenderedUpdateRate = FrameSkip + 1;
+	}
+	else
+	{
+		Params->BaseNonRenderedUpdateRate = FMath::Max(1, CVarURONonRenderedUpdateRate.GetValueOnGameThread());
+	}
+}
+
+void AShooterCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AShooterCharacter, EquippedWeapon);
 }
 
 void AShooterCharacter::MoveForward(float Value)
@@ -177,45 +349,161 @@ bool AShooterCharacter::WeaponHasAmmo()
 
 void AShooterCharacter::PlayFireSound()
 {
-	if (FireSound)
+#if !UE_SERVER
+	// The 2D fire sound is only for the player holding the gun
+	if (EquippedWeapon == nullptr || !IsLocallyControlled()) return;
+
+	USoundCue* Sound = EquippedWeapon->GetWeaponDefinition()->GetFireSound();
+	if (Sound == nullptr)
+	{
+		Sound = FireSound;
+	}
+	if (Sound)
 	{
-		UGameplayStatics::PlaySound2D(this, FireSound);
+		UGameplayStatics::PlaySound2D(this, Sound);
 	}
+#endif
 }
 
-void AShooterCharacter::SendBullet()
+void AShooterCharacter::SendBullet(float ShotAge, bool bMuzzleFlash)
 {
-	const USkeletalMeshSocket* BarrelSocket = EquippedWeapon->GetItemMesh()->GetSocketByName("BarrelSocket");
-	if (BarrelSocket)
-	{
-		const FTransform SocketTransform = BarrelSocket->GetSocketTransform(EquippedWeapon->GetItemMesh());
+	if (EquippedWeapon == nullptr) return;
 
-		if (MuzzleFlash)
+	SCOPE_CYCLE_COUNTER(STAT_SendBullet);
+	CSV_SCOPED_TIMING_STAT(Shooter, SendBullet);
+	INC_DWORD_STAT(STAT_BulletsSent);
+	CSV_CUSTOM_STAT(Shooter, BulletsSent, 1, ECsvCustomStatOp::Accumulate);
+
+	// Barrel socket is resolved once per weapon, so no name lookup here
+	FTransform SocketTransform;
+	if (EquippedWeapon->GetBarrelSocketTransform(SocketTransform))
+	{
+		const UWeaponDefinition* WeaponDefinition = EquippedWeapon->GetWeaponDefinition();
+#if !UE_SERVER
+		UParticleSystem* Flash = WeaponDefinition->GetMuzzleFlash() ? WeaponDefinition->GetMuzzleFlash() : MuzzleFlash;
+		// Nobody sees the muzzle of a Low significance character, e.g. one a listen server is replaying shots for
+		if (bMuzzleFlash && Flash && !IsRunningDedicatedServer() && Significance != EShooterSignificance::ESS_Low)
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MuzzleFlash, SocketTransform);
+			SpawnShotEmitter(Flash, SocketTransform);
 		}
+#endif
 
-		FVector BeamEnd;
-		bool bBeamEnd = GetBeamEndLocation(SocketTransform.GetLocation(), BeamEnd);
+		FHitscanShotRequest Shot;
+		Shot.Instigator = this;
+		Shot.WeaponDefinition = WeaponDefinition;
+		Shot.MuzzleTransform = SocketTransform;
+		Shot.ShotAge = ShotAge;
 
-		if (bBeamEnd)
+		if (!GetShotAim(Shot)) return;
+
+		if (WeaponDefinition->IsBallistic())
 		{
-			if (ImpactParticles)
+			// Aim the round from the barrel at what the crosshairs point at. Rounds fired earlier in the frame start further along
+			UShooterProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UShooterProjectileSubsystem>();
+			const FVector MuzzleLocation = SocketTransform.GetLocation();
+			const FVector Velocity = (Shot.AimEnd - MuzzleLocation).GetSafeNormal() * WeaponDefinition->GetMuzzleVelocity();
+			if (Projectiles && Projectiles->LaunchProjectile(MuzzleLocation, Velocity, WeaponDefinition->GetProjectileDrag(),
+				WeaponDefinition->GetProjectileLifetime(), this, WeaponDefinition, ShotAge))
 			{
-				// Spawn impact particles after updating beam end point
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, BeamEnd);
+				return;
 			}
+		}
+
+		UShooterHitscanSubsystem* Hitscan = GetWorld()->GetSubsystem<UShooterHitscanSubsystem>();
+		if (Hitscan)
+		{
+			Hitscan->QueueShot(Shot);
+		}
+	}
+}
+
+bool AShooterCharacter::GetShotAim(FHitscanShotRequest& Shot)
+{
+	if (IsLocallyControlled() && !IsPlayerControlled())
+	{
+		// AI has no crosshairs, it aims along its control rotation
+		FVector EyesLocation;
+		FRotator EyesRotation;
+		GetActorEyesViewPoint(EyesLocation, EyesRotation);
+
+		Shot.AimStart = EyesLocation;
+		Shot.AimEnd = EyesLocation + EyesRotation.Vector() * CrosshairTraceLength;
+		Shot.bAimTraced = false;
+		return true;
+	}
+
+	if (IsLocallyControlled())
+	{
+		if (!UpdateCrosshairView()) return false;
 
-			if (BeamParticles)
+		// Aim along the crosshairs. If item tracing already traced them this frame, pass the hit along
+		Shot.AimStart = CrosshairQuery.ViewOrigin;
+		Shot.AimEnd = CrosshairQuery.bTraced ? CrosshairQuery.HitLocation : CrosshairQuery.TraceEnd;
+		Shot.bAimTraced = CrosshairQuery.bTraced;
+		if (Shot.bAimTraced)
+		{
+			INC_DWORD_STAT(STAT_CrosshairQueriesSaved);
+		}
+
+		// Clients tell the server about their shots a burst at a time
+		if (!HasAuthority())
+		{
+			FireBurst->RecordShot(CrosshairQuery.ViewOrigin, CrosshairQuery.ViewDirection, Shot.ShotAge);
+		}
+		return true;
+	}
+
+	// Server replaying a shot the owning client sent in a burst
+	FVector AimOrigin;
+	FVector AimDirection;
+	float ShotTime;
+	if (!FireBurst->PopReplayShot(AimOrigin, AimDirection, ShotTime)) return false;
+
+	Shot.AimStart = AimOrigin;
+	Shot.AimEnd = AimOrigin + AimDirection * CrosshairTraceLength;
+	Shot.bAimTraced = false;
+	Shot.RewindTime = ShotTime;
+	return true;
+}
+
+void AShooterCharacter::OnShotResolved(const FHitscanShotResult& Result)
+{
+#if !UE_SERVER
+	// Impacts and beams are purely cosmetic
+	if (IsRunningDedicatedServer()) return;
+
+	if (Result.bHit)
+	{
+		// The character's own particles stand in for any the weapon's definition doesn't have
+		UParticleSystem* Impact = Result.WeaponDefinition && Result.WeaponDefinition->GetImpactParticles() ? Result.WeaponDefinition->GetImpactParticles() : ImpactParticles;
+		UParticleSystem* Trail = Result.WeaponDefinition && Result.WeaponDefinition->GetBeamParticles() ? Result.WeaponDefinition->GetBeamParticles() : BeamParticles;
+
+		if (Impact)
+		{
+			// Spawn impact particles after updating beam end point
+			SpawnShotEmitter(Impact, FTransform(Result.BeamEnd));
+		}
+
+		if (Trail)
+		{
+			UParticleSystemComponent* Beam = SpawnShotEmitter(Trail, Result.MuzzleTransform);
+			if (Beam)
 			{
-				UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), BeamParticles, SocketTransform);
-				if (Beam)
-				{
-					Beam->SetVectorParameter(FName("Target"), BeamEnd);
-				}
+				Beam->SetVectorParameter(FName("Target"), Result.BeamEnd);
 			}
 		}
 	}
+#endif
+}
+
+UParticleSystemComponent* AShooterCharacter::SpawnShotEmitter(UParticleSystem* Template, const FTransform& Transform)
+{
+	UShooterEmitterPoolSubsystem* EmitterPool = GetWorld()->GetSubsystem<UShooterEmitterPoolSubsystem>();
+	if (EmitterPool)
+	{
+		return EmitterPool->SpawnEmitter(Template, Transform);
+	}
+	return UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Template, Transform);
 }
 
 void AShooterCharacter::PlayGunFireMontage()
@@ -229,7 +517,7 @@ void AShooterCharacter::PlayGunFireMontage()
 	}
 }
 
-void AShooterCharacter::FireWeapon()
+void AShooterCharacter::FireWeapon(float ShotAge)
 {
 	// Check we have a weapon
 	if (EquippedWeapon == nullptr) return;
@@ -239,50 +527,28 @@ void AShooterCharacter::FireWeapon()
 
 	if (WeaponHasAmmo()) {
 
-		PlayFireSound();
-		SendBullet();
-		PlayGunFireMontage();
+		// Shots that fall in the same frame share one sound, muzzle flash and montage
+		const bool bPlayCosmetics = LastShotCosmeticsFrame != GFrameCounter;
+		LastShotCosmeticsFrame = GFrameCounter;
+
+		if (bPlayCosmetics)
+		{
+			PlayFireSound();
+		}
+		SendBullet(ShotAge, bPlayCosmetics);
+		if (bPlayCosmetics)
+		{
+			PlayGunFireMontage();
+		}
 
 		// Decrease the weapon's ammo
 		EquippedWeapon->DecrementAmmo();
 		StartCrosshairBulletFire();
 
-		StartFireTimer();
+		StartFireTimer(ShotAge);
 	}
 }
 
-bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation, FVector& OutBeamLocation)
-{
-	// Check for crosshair trace hit
-	FHitResult CrosshairHitResult;
-	bool bCrosshairHit = TraceUnderCrosshairs(CrosshairHitResult, OutBeamLocation);
-
-	if (bCrosshairHit)
-	{
-		// Tentative beam location. Still need to trace from barrel
-		OutBeamLocation = CrosshairHitResult.Location;
-	}
-	else
-	{
-		// No crosshair trace hit. OutBeamLocation is set to the end location for the line trace
-	}
-
-	// Perform trace from gun barrel
-	FHitResult WeaponTraceHit;
-	const FVector WeaponTraceStart(MuzzleSocketLocation);
-	const FVector StartToEnd(OutBeamLocation - MuzzleSocketLocation);
-	const FVector WeaponTraceEnd(MuzzleSocketLocation + StartToEnd * 1.25f);
-	GetWorld()->LineTraceSingleByChannel(WeaponTraceHit, WeaponTraceStart, WeaponTraceEnd, ECollisionChannel::ECC_Visibility);
-
-	if (WeaponTraceHit.bBlockingHit)
-	{
-		//Object between barrel and beam endpoint
-		OutBeamLocation = WeaponTraceHit.Location;
-		return true;
-	}
-	return false;
-}
-
 void AShooterCharacter::AimingButtonPressed()
 {
 	bAiming = true;
@@ -360,7 +626,19 @@ void AShooterCharacter::CalculateCrosshairSpread(float DeltaTime)
 	{
 		CrosshairShootingFactor = FMath::FInterpTo(CrosshairShootingFactor, 0.f, DeltaTime, 60.f);
 	}
+	const float PreviousCrosshairSpread = CrosshairSpreadMultiplier;
 	CrosshairSpreadMultiplier = 0.5f + CrosshairVelocityFactor + CrosshairInAirFactor - CrosshairAimFactor + CrosshairShootingFactor;
+
+	// The factors ease towards rest, so once the character is still nothing is sent to the HUD. Small moves are
+	// held back until the spread settles, then sent once so the HUD ends up at the resting spread
+	const bool bMovedPastTolerance = !FMath::IsNearlyEqual(CrosshairSpreadMultiplier, BroadcastCrosshairSpread, CVarHUDCrosshairSpreadTolerance.GetValueOnGameThread());
+	const bool bSettled = FMath::IsNearlyEqual(CrosshairSpreadMultiplier, PreviousCrosshairSpread)
+		&& !FMath::IsNearlyEqual(CrosshairSpreadMultiplier, BroadcastCrosshairSpread);
+	if (bMovedPastTolerance || bSettled)
+	{
+		BroadcastCrosshairSpread = CrosshairSpreadMultiplier;
+		OnCrosshairSpreadChanged.Broadcast(CrosshairSpreadMultiplier);
+	}
 }
 
 void AShooterCharacter::StartCrosshairBulletFire()
@@ -385,71 +663,148 @@ void AShooterCharacter::FireButtonReleased()
 	bFireButtonPressed = false;
 }
 
-void AShooterCharacter::StartFireTimer()
+void AShooterCharacter::SetFireButtonHeld(bool bHeld)
+{
+	if (bHeld)
+	{
+		FireButtonPressed();
+	}
+	else
+	{
+		FireButtonReleased();
+	}
+}
+
+void AShooterCharacter::StartBurstReplay()
+{
+	if (CombatState != ECombatState::ECS_Unoccupied) return;
+	if (!FireBurst->HasReplayShots()) return;
+
+	if (WeaponHasAmmo())
+	{
+		FireWeapon();
+	}
+	else
+	{
+		ReloadWeapon();
+	}
+}
+
+void AShooterCharacter::StartFireTimer(float ShotAge)
 {
 	CombatState = ECombatState::ECS_FireTimeInProgress;
-	GetWorldTimerManager().SetTimer(AutoFireTimer, this, &AShooterCharacter::AutoFireReset, AutomaticFireRate);
+	const UWeaponDefinition* WeaponDefinition = EquippedWeapon->GetWeaponDefinition();
+	const float AutomaticFireRate = WeaponDefinition ? WeaponDefinition->GetAutomaticFireRate() : 0.1f;
+
+	// Counting from when the shot was due rather than when the frame got to it keeps the rate exact
+	FireCooldown = AutomaticFireRate - ShotAge;
+	FireTimerStartFrame = GFrameCounter;
+}
+
+void AShooterCharacter::TickAutoFire(float DeltaTime)
+{
+	if (CombatState != ECombatState::ECS_FireTimeInProgress) return;
+
+	// A press handled earlier this frame, e.g. by the controller's input, came after this frame's DeltaTime had passed
+	if (FireTimerStartFrame != GFrameCounter)
+	{
+		FireCooldown -= DeltaTime;
+	}
+
+	// Fire every shot that fell due this frame, each knowing how far into the frame it was due
+	const int32 MaxShots = CVarMaxShotsPerFrame.GetValueOnGameThread();
+	int32 NumShots = 0;
+	while (CombatState == ECombatState::ECS_FireTimeInProgress && FireCooldown <= 0.f)
+	{
+		if (NumShots++ >= MaxShots)
+		{
+			// Drop what a hitch left owing rather than firing it all at once
+			FireCooldown = 0.f;
+			break;
+		}
+		AutoFireReset();
+	}
 }
 
 void AShooterCharacter::AutoFireReset()
 {
+	const float ShotAge = FMath::Max(-FireCooldown, 0.f);
+
 	CombatState = ECombatState::ECS_Unoccupied;
 	if (WeaponHasAmmo())
 	{
-		if (bFireButtonPressed)
+		// The server keeps firing while it has shots from the owning client to replay
+		if (bFireButtonPressed || FireBurst->HasReplayShots())
 		{
-			FireWeapon();
+			FireWeapon(ShotAge);
 		}
 	}
 	else
 	{
 		ReloadWeapon();
 	}
+
+	if (CombatState == ECombatState::ECS_Unoccupied)
+	{
+		// The burst is over, send the server whatever it hasn't heard about yet
+		FireBurst->FlushBurst();
+
+		if (bServerReloadPending)
+		{
+			bServerReloadPending = false;
+
+			// The magazine may have been refilled since the client asked, e.g. by an auto-reload on running dry
+			if (EquippedWeapon && EquippedWeapon->GetAmmoCount() < EquippedWeapon->GetMagazineCapacity())
+			{
+				ReloadWeapon();
+			}
+		}
+	}
 }
 
 void AShooterCharacter::FinishReloading()
 {
+	SCOPE_CYCLE_COUNTER(STAT_FinishReloading);
+	CSV_SCOPED_TIMING_STAT(Shooter, FinishReloading);
+
 	CombatState = ECombatState::ECS_Unoccupied;
+	ApplyAnimUpdateRate(GetMesh()->AnimUpdateRateParams);
 
 	if (EquippedWeapon == nullptr) return;
 
 	const auto AmmoType = EquippedWeapon->GetAmmoType();
-	// Update ammo map after reloading
-	if (AmmoMap.Contains(AmmoType))
-	{
-		// Amount of ammo of this type that the character is carrying
-		int32 CarriedAmmo = AmmoMap[AmmoType];
 
-		// Calculate amount of empty space in the magazine
-		const int32 MagazineEmptySpace = EquippedWeapon->GetMagazineCapacity() - EquippedWeapon->GetAmmoCount();
+	// Amount of ammo of this type that the character is carrying
+	int32 CarriedAmmo = Inventory->GetAmmo(AmmoType);
 
-		if (MagazineEmptySpace > CarriedAmmo)
-		{
-			// Reload magazine with remaining carried ammo of this type
-			EquippedWeapon->ReloadAmmo(CarriedAmmo);
-			CarriedAmmo = 0;
-		}
-		else
-		{
-			// Fill the magazine
-			EquippedWeapon->ReloadAmmo(MagazineEmptySpace);
-			CarriedAmmo -= MagazineEmptySpace;
-		}
-		AmmoMap.Add(AmmoType, CarriedAmmo);
+	// Calculate amount of empty space in the magazine
+	const int32 MagazineEmptySpace = EquippedWeapon->GetMagazineCapacity() - EquippedWeapon->GetAmmoCount();
+
+	if (MagazineEmptySpace > CarriedAmmo)
+	{
+		// Reload magazine with remaining carried ammo of this type
+		EquippedWeapon->ReloadAmmo(CarriedAmmo);
+		CarriedAmmo = 0;
 	}
+	else
+	{
+		// Fill the magazine
+		EquippedWeapon->ReloadAmmo(MagazineEmptySpace);
+		CarriedAmmo -= MagazineEmptySpace;
+	}
+
+	// Update inventory after reloading
+	Inventory->SetAmmo(AmmoType, CarriedAmmo);
+
+	// Carry on with any shots the owning client fired after its reload
+	StartBurstReplay();
 }
 
 bool AShooterCharacter::CarryingAmmo()
 {
 	if (EquippedWeapon == nullptr) return false;
 
-	auto AmmoType = EquippedWeapon->GetAmmoType();
-
-	if (AmmoMap.Contains(AmmoType))
-	{
-		return AmmoMap[AmmoType] > 0;
-	}
-	return false;
+	return Inventory->GetAmmo(EquippedWeapon->GetAmmoType()) > 0;
 }
 
 void AShooterCharacter::GrabClip()
@@ -457,7 +812,9 @@ void AShooterCharacter::GrabClip()
 	if (EquippedWeapon == nullptr) return;
 	if (HandSceneComponent == nullptr) return;
 
-	int32 ClipBoneIndex = EquippedWeapon->GetItemMesh()->GetBoneIndex(EquippedWeapon->GetClipBoneName());
+	// Clip bone is resolved once per weapon, so no name lookup here
+	const int32 ClipBoneIndex = EquippedWeapon->GetClipBoneIndex();
+	if (ClipBoneIndex == INDEX_NONE) return;
 
 	// Store the transform of the clip
 	ClipTransform = EquippedWeapon->GetItemMesh()->GetBoneTransform(ClipBoneIndex);
@@ -476,6 +833,23 @@ void AShooterCharacter::ReleaseClip()
 
 bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation)
 {
+	const FCrosshairQuery& Query = GetCrosshairQuery();
+	OutHitResult = Query.HitResult;
+	OutHitLocation = Query.HitLocation;
+	return Query.HitResult.bBlockingHit;
+}
+
+bool AShooterCharacter::UpdateCrosshairView()
+{
+	if (CrosshairQuery.FrameNumber == GFrameCounter)
+	{
+		// Already deprojected this frame
+		return CrosshairQuery.bViewValid;
+	}
+
+	CrosshairQuery.FrameNumber = GFrameCounter;
+	CrosshairQuery.bTraced = false;
+
 	// Get viewport size
 	FVector2D ViewportSize;
 	if (GEngine && GEngine->GameViewport) {
@@ -484,62 +858,134 @@ bool AShooterCharacter::TraceUnderCrosshairs(FHitResult& OutHitResult, FVector&
 
 	// Get screenspace location of crosshairs
 	FVector2D CrosshairLocation(ViewportSize.X / 2.f, ViewportSize.Y / 2.f);
-	FVector CrosshairWorldPosition;
-	FVector CrosshairWorldDirection;
 
 	// Get the world position of the crosshairs from the screenspace position
-	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(UGameplayStatics::GetPlayerController(this, 0), CrosshairLocation, CrosshairWorldPosition, CrosshairWorldDirection);
+	CrosshairQuery.bViewValid = UGameplayStatics::DeprojectScreenToWorld(UGameplayStatics::GetPlayerController(this, 0), CrosshairLocation, CrosshairQuery.ViewOrigin, CrosshairQuery.ViewDirection);
+
+	// Trace from crosshair screen location, outward
+	CrosshairQuery.TraceEnd = CrosshairQuery.ViewOrigin + CrosshairQuery.ViewDirection * CrosshairTraceLength;
+
+	return CrosshairQuery.bViewValid;
+}
 
-	if (bScreenToWorld)
+const FCrosshairQuery& AShooterCharacter::GetCrosshairQuery()
+{
+	UpdateCrosshairView();
+
+	if (CrosshairQuery.bTraced)
 	{
-		// Trace from crosshair screen location, outward
-		const FVector Start(CrosshairWorldPosition);
-		const FVector End(CrosshairWorldDirection + CrosshairWorldDirection * 50000.f);
-		OutHitLocation = End;
-		GetWorld()->LineTraceSingleByChannel(OutHitResult, Start, End, ECollisionChannel::ECC_Visibility);
-		
-		if (OutHitResult.bBlockingHit)
+		// Someone already traced this frame, reuse their result
+		INC_DWORD_STAT(STAT_CrosshairQueriesSaved);
+		return CrosshairQuery;
+	}
+
+	CrosshairQuery.bTraced = true;
+	CrosshairQuery.HitResult = FHitResult();
+	CrosshairQuery.HitLocation = CrosshairQuery.TraceEnd;
+
+	if (CrosshairQuery.bViewValid)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_CrosshairTrace);
+		CSV_SCOPED_TIMING_STAT(Shooter, CrosshairTrace);
+		INC_DWORD_STAT(STAT_CrosshairTraces);
+		CSV_CUSTOM_STAT(Shooter, CrosshairTraces, 1, ECsvCustomStatOp::Accumulate);
+		GetWorld()->LineTraceSingleByChannel(CrosshairQuery.HitResult, CrosshairQuery.ViewOrigin, CrosshairQuery.TraceEnd, ECollisionChannel::ECC_Visibility);
+
+		if (CrosshairQuery.HitResult.bBlockingHit)
 		{
-			OutHitLocation = OutHitResult.Location;
-			return true;
+			CrosshairQuery.HitLocation = CrosshairQuery.HitResult.Location;
 		}
 	}
-	return false;
+	return CrosshairQuery;
+}
+
+void AShooterCharacter::UpdateNearbyItems()
+{
+	const UItemSpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UItemSpatialSubsystem>();
+	// Counts the capsule, as the overlap between it and the item's area sphere used to
+	bShouldTraceForItems = SpatialSubsystem && SpatialSubsystem->HasItemInReach(GetActorLocation(), GetCapsuleComponent()->GetScaledCapsuleRadius());
 }
 
 void AShooterCharacter::TraceForItems()
 {
+	SCOPE_CYCLE_COUNTER(STAT_TraceForItems);
+	CSV_SCOPED_TIMING_STAT(Shooter, TraceForItems);
+
 	if (bShouldTraceForItems)
 	{
-		FHitResult ItemTraceResult;
-		FVector HitLocation;
-		TraceUnderCrosshairs(ItemTraceResult, HitLocation);
-		if (ItemTraceResult.bBlockingHit)
+		// If something already traced under the crosshairs this frame (e.g. firing) the result is free to use
+		const bool bCrosshairTracedThisFrame = CrosshairQuery.FrameNumber == GFrameCounter && CrosshairQuery.bTraced;
+
+		if (CVarAsyncItemTrace.GetValueOnGameThread() != 0 && !bCrosshairTracedThisFrame)
 		{
-			TraceHitItem = Cast<AItem>(ItemTraceResult.Actor);
-			if (TraceHitItem && TraceHitItem->GetPickupWidget())
+			// Apply the result of the trace we issued last frame
+			FTraceDatum ItemTraceDatum;
+			if (ItemTraceHandle.IsValid() && GetWorld()->QueryTraceData(ItemTraceHandle, ItemTraceDatum))
 			{
-				// Show item pickup widget
-				TraceHitItem->GetPickupWidget()->SetVisibility(true);
+				UpdateTraceHitItem(ItemTraceDatum.OutHits.Num() > 0 ? ItemTraceDatum.OutHits[0] : FHitResult());
 			}
 
-			// Did we hit an AItem last frame?
-			if (TraceHitItemLastFrame)
+			// Issue this frame's trace, to be picked up next frame
+			ItemTraceHandle.Invalidate();
+			if (UpdateCrosshairView())
 			{
-				if (TraceHitItem != TraceHitItemLastFrame)
-				{
-					// We are hitting a different AItem (or AItem is now null) so make LastFrame AItem invisible
-					TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
-				}
+				INC_DWORD_STAT(STAT_CrosshairTraces);
+				CSV_CUSTOM_STAT(Shooter, CrosshairTraces, 1, ECsvCustomStatOp::Accumulate);
+				ItemTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, CrosshairQuery.ViewOrigin, CrosshairQuery.TraceEnd, ECollisionChannel::ECC_Visibility);
 			}
-			// Store reference to hit item from last frame
-			TraceHitItemLastFrame = TraceHitItem;
+		}
+		else
+		{
+			// This frame's result supersedes any async trace still in flight, which would be stale next frame
+			ItemTraceHandle.Invalidate();
+
+			FHitResult ItemTraceResult;
+			FVector HitLocation;
+			TraceUnderCrosshairs(ItemTraceResult, HitLocation);
+			UpdateTraceHitItem(ItemTraceResult);
+		}
+	}
+	else
+	{
+		ItemTraceHandle.Invalidate();
+
+		if (TraceHitItemLastFrame)
+		{
+			// No longer near any items
+			HidePickupWidget();
+			TraceHitItemLastFrame = nullptr;
 		}
 	}
-	else if (TraceHitItemLastFrame)
+}
+
+void AShooterCharacter::UpdateTraceHitItem(const FHitResult& ItemTraceResult)
+{
+	if (ItemTraceResult.bBlockingHit)
 	{
-		// No longer overlapping any items
-		TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
+		TraceHitItem = Cast<AItem>(ItemTraceResult.Actor);
+
+		// An async result is a frame old, so the item may have been picked up since it was traced
+		if (TraceHitItem && TraceHitItem->GetItemState() != EItemState::EIS_Pickup)
+		{
+			TraceHitItem = nullptr;
+		}
+
+		AShooterPlayerController* ShooterPlayerController = Cast<AShooterPlayerController>(Controller);
+		if (TraceHitItem)
+		{
+			// Point the pickup widget at the item and show it
+			if (ShooterPlayerController)
+			{
+				ShooterPlayerController->ShowPickupWidget(TraceHitItem);
+			}
+		}
+		else if (TraceHitItemLastFrame)
+		{
+			// We hit an AItem last frame but not this frame so hide the widget
+			HidePickupWidget();
+		}
+		// Store reference to hit item from last frame
+		TraceHitItemLastFrame = TraceHitItem;
 	}
 }
 
@@ -587,11 +1033,19 @@ void AShooterCharacter::EquipWeapon(AWeapon* WeaponToEquip)
 		{
 			HandSocket->AttachActor(WeaponToEquip, GetMesh());
 		}
+		AWeapon* OldWeapon = EquippedWeapon;
 		EquippedWeapon = WeaponToEquip;
 		EquippedWeapon->SetItemState(EItemState::EIS_Equipped);
+		NotifyEquipWeapon.Broadcast(this, EquippedWeapon, OldWeapon);
+		OnEquipWeapon.Broadcast(this, EquippedWeapon, OldWeapon);
 	}
 }
 
+void AShooterCharacter::OnRep_EquippedWeapon(AWeapon* OldWeapon)
+{
+	OnEquipWeapon.Broadcast(this, EquippedWeapon, OldWeapon);
+}
+
 void AShooterCharacter::DropWeapon()
 {
 	if (EquippedWeapon)
@@ -607,7 +1061,105 @@ void AShooterCharacter::SelectButtonPressed()
 {
 	if (TraceHitItem)
 	{
-		TraceHitItem->StartItemCurve(this);
+		if (HasAuthority())
+		{
+			TraceHitItem->StartItemCurve(this);
+		}
+		else
+		{
+			// The server moves the item and swaps weapons, clients see it through replication
+			ServerSelectItem(TraceHitItem);
+		}
+		HidePickupWidget();
+	}
+}
+
+void AShooterCharacter::SelectItem(AItem* Item)
+{
+	if (Item == nullptr || Item->GetItemState() != EItemState::EIS_Pickup) return;
+
+	TraceHitItem = Item;
+	SelectButtonPressed();
+}
+
+/** Names bound in SetupPlayerInputComponent, indexed by EShooterInputAxis and EShooterInputAction */
+static const FName InputAxisNames[] = { "MoveForward", "MoveRight", "TurnAtRate", "LookUpAtRate", "Turn", "LookUp" };
+static const FName InputActionNames[] = { "Jump", "FireButton", "AimButton", "Select", "ReloadButton" };
+static_assert(UE_ARRAY_COUNT(InputAxisNames) == static_cast<int32>(EShooterInputAxis::MAX), "InputAxisNames must match EShooterInputAxis");
+static_assert(UE_ARRAY_COUNT(InputActionNames) == static_cast<int32>(EShooterInputAction::MAX), "InputActionNames must match EShooterInputAction");
+
+void AShooterCharacter::CaptureInputFrame(FShooterInputFrame& Frame) const
+{
+	if (InputComponent)
+	{
+		for (int32 Axis = 0; Axis < UE_ARRAY_COUNT(InputAxisNames); Axis++)
+		{
+			Frame.Axes[Axis] = InputComponent->GetAxisValue(InputAxisNames[Axis]);
+		}
+	}
+
+	const APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	if (PlayerController == nullptr || PlayerController->PlayerInput == nullptr) return;
+
+	for (int32 Action = 0; Action < UE_ARRAY_COUNT(InputActionNames); Action++)
+	{
+		for (const FInputActionKeyMapping& Mapping : PlayerController->PlayerInput->GetKeysForAction(InputActionNames[Action]))
+		{
+			if (PlayerController->WasInputKeyJustPressed(Mapping.Key))
+			{
+				Frame.PressedActions |= 1 << Action;
+			}
+			if (PlayerController->WasInputKeyJustReleased(Mapping.Key))
+			{
+				Frame.ReleasedActions |= 1 << Action;
+			}
+		}
+	}
+}
+
+void AShooterCharacter::ApplyInputFrame(const FShooterInputFrame& Frame)
+{
+	MoveForward(Frame.Axes[static_cast<int32>(EShooterInputAxis::MoveForward)]);
+	MoveRight(Frame.Axes[static_cast<int32>(EShooterInputAxis::MoveRight)]);
+	TurnAtRate(Frame.Axes[static_cast<int32>(EShooterInputAxis::TurnAtRate)]);
+	LookupAtRate(Frame.Axes[static_cast<int32>(EShooterInputAxis::LookUpAtRate)]);
+	Turn(Frame.Axes[static_cast<int32>(EShooterInputAxis::Turn)]);
+	LookUp(Frame.Axes[static_cast<int32>(EShooterInputAxis::LookUp)]);
+
+	// Releases first, so a tap recorded within one frame ends up released
+	if (Frame.WasReleased(EShooterInputAction::Jump)) StopJumping();
+	if (Frame.WasReleased(EShooterInputAction::Fire)) FireButtonReleased();
+	if (Frame.WasReleased(EShooterInputAction::Aim)) AimingButtonReleased();
+	if (Frame.WasReleased(EShooterInputAction::Select)) SelectButtonReleased();
+
+	if (Frame.WasPressed(EShooterInputAction::Jump)) Jump();
+	if (Frame.WasPressed(EShooterInputAction::Fire)) FireButtonPressed();
+	if (Frame.WasPressed(EShooterInputAction::Aim)) AimingButtonPressed();
+	if (Frame.WasPressed(EShooterInputAction::Select)) SelectButtonPressed();
+	if (Frame.WasPressed(EShooterInputAction::Reload)) ReloadButtonPressed();
+}
+
+void AShooterCharacter::ServerSelectItem_Implementation(AItem* Item)
+{
+	if (Item == nullptr || Item->GetItemState() != EItemState::EIS_Pickup) return;
+
+	// The client traced for the item within its pickup reach. Allow for the character having moved since
+	const float Reach = Item->GetPickupRadius() + GetCapsuleComponent()->GetScaledCapsuleRadius() + PickupReachTolerance;
+	if (FVector::DistSquared(Item->GetActorLocation(), GetActorLocation()) > FMath::Square(Reach))
+	{
+		UE_LOG(LogShooter, Verbose, TEXT("%s tried to pick up %s from out of reach"), *GetName(), *Item->GetName());
+		return;
+	}
+
+	Item->StartItemCurve(this);
+}
+
+void AShooterCharacter::HidePickupWidget()
+{
+	AShooterPlayerController* ShooterPlayerController = Cast<AShooterPlayerController>(Controller);
+	if (ShooterPlayerController)
+	{
+		ShooterPlayerController->HidePickupWidget();
 	}
 }
 
@@ -616,20 +1168,35 @@ void AShooterCharacter::SelectButtonReleased()
 
 }
 
-void AShooterCharacter::InitialiseAmmoMap()
+void AShooterCharacter::InitialiseAmmo()
+{
+	Inventory->SetAmmo(EAmmoType::EAT_9mm, Starting9mmAmmo);
+	Inventory->SetAmmo(EAmmoType::EAT_AR, StartingARAmmo);
+}
+
+void AShooterCharacter::HandleInventoryAmmoChanged(EAmmoType AmmoType, int32 Amount)
 {
-	AmmoMap.Add(EAmmoType::EAT_9mm, Starting9mmAmmo);
-	AmmoMap.Add(EAmmoType::EAT_AR, StartingARAmmo);
+	AmmoMap.Add(AmmoType, Amount);
 }
 
 // Called every frame
 void AShooterCharacter::Tick(float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CharacterTick);
+	CSV_SCOPED_TIMING_STAT(Shooter, CharacterTick);
 	Super::Tick(DeltaTime);
-	CameraInterpZoom(DeltaTime);
-	SetLookRates();
-	CalculateCrosshairSpread(DeltaTime);
-	TraceForItems();
+
+	TickAutoFire(DeltaTime);
+
+	// Camera, crosshairs and item traces only matter to the player controlling this character
+	if (IsLocalPlayerCharacter())
+	{
+		CameraInterpZoom(DeltaTime);
+		SetLookRates();
+		CalculateCrosshairSpread(DeltaTime);
+		UpdateNearbyItems();
+		TraceForItems();
+	}
 }
 
 // Called to bind functionality to input
@@ -661,20 +1228,6 @@ float AShooterCharacter::GetCrosshairSpreadMultiplier() const
 	return CrosshairSpreadMultiplier;
 }
 
-void AShooterCharacter::IncrementOverlappedItemCount(int8 Amount)
-{
-	if (OverlappedItemCount + Amount <= 0)
-	{
-		OverlappedItemCount = 0;
-		bShouldTraceForItems = false;
-	}
-	else
-	{
-		OverlappedItemCount += Amount;
-		bShouldTraceForItems = true;
-	}
-}
-
 void AShooterCharacter::ReloadButtonPressed()
 {
 	ReloadWeapon();
@@ -688,10 +1241,35 @@ void AShooterCharacter::ReloadWeapon()
 	if (CarryingAmmo())
 	{
 		CombatState = ECombatState::ECS_Reloading;
+		ApplyAnimUpdateRate(GetMesh()->AnimUpdateRateParams);
+
+		// Any reload the owning client asked for is covered by this one
+		bServerReloadPending = false;
+
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 		if (AnimInstance && ReloadMontage) {
 			AnimInstance->Montage_Play(ReloadMontage);
 			AnimInstance->Montage_JumpToSection(EquippedWeapon->GetReloadMontageSection());
 		}
+
+		if (IsLocallyControlled() && !HasAuthority())
+		{
+			// Send the shots fired before the reload first, RPCs arrive in order
+			FireBurst->FlushBurst();
+			ServerReloadWeapon();
+		}
+	}
+}
+
+void AShooterCharacter::ServerReloadWeapon_Implementation()
+{
+	if (CombatState == ECombatState::ECS_Unoccupied && !FireBurst->HasReplayShots())
+	{
+		ReloadWeapon();
+	}
+	else
+	{
+		// Reload once the shots already received have been replayed
+		bServerReloadPending = true;
 	}
 }
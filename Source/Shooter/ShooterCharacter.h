@@ -4,9 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "WorldCollision.h"
 #include "AmmoType.h"
+#include "ShooterSignificance.h"
 #include "ShooterCharacter.generated.h"
 
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnShooterCharacterEquipWeapon, class AShooterCharacter*, class AWeapon* /* NewWeapon */, class AWeapon* /* OldWeapon */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnShooterCharacterCrosshairSpreadChanged, float /* CrosshairSpreadMultiplier */);
+
 UENUM(BlueprintType)
 enum class ECombatState : uint8
 {
@@ -17,6 +22,32 @@ enum class ECombatState : uint8
 	ECS_MAX UMETA(DisplayName = "DefaultMAX"),
 };
 
+/** Crosshair deprojection and trace result, computed at most once per frame and shared by item tracing and firing */
+struct FCrosshairQuery
+{
+	/** Frame counter value the query was last computed on */
+	uint64 FrameNumber = MAX_uint64;
+
+	/** True if the crosshairs could be deprojected into the world this frame */
+	bool bViewValid = false;
+
+	/** True once the line trace has been run for this frame */
+	bool bTraced = false;
+
+	/** World position and direction of the crosshairs */
+	FVector ViewOrigin = FVector::ZeroVector;
+	FVector ViewDirection = FVector::ForwardVector;
+
+	/** End point of the crosshair line trace */
+	FVector TraceEnd = FVector::ZeroVector;
+
+	/** Result of the crosshair line trace */
+	FHitResult HitResult;
+
+	/** Location of the blocking hit, or TraceEnd if nothing was hit */
+	FVector HitLocation = FVector::ZeroVector;
+};
+
 UCLASS()
 class SHOOTER_API AShooterCharacter : public ACharacter
 {
@@ -26,9 +57,21 @@ public:
 	// Sets default values for this character's properties
 	AShooterCharacter();
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Broadcast on the server when a character equips a weapon, so replication can tie the weapon to its owner */
+	static FOnShooterCharacterEquipWeapon NotifyEquipWeapon;
+
+	/** Broadcast when this character's equipped weapon changes, on the server and on clients as it replicates */
+	FOnShooterCharacterEquipWeapon OnEquipWeapon;
+
+	/** Broadcast when the crosshair spread moves by more than Shooter.HUD.CrosshairSpreadTolerance */
+	FOnShooterCharacterCrosshairSpreadChanged OnCrosshairSpreadChanged;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** Called for forwards / backwards input */
 	void MoveForward(float Value);
@@ -60,10 +103,8 @@ protected:
 	**/
 	void LookUp(float Value);
 
-	/** Called when the FireButton action is invoked */
-	void FireWeapon();
-
-	bool GetBeamEndLocation(const FVector& MuzzleSocketLocation, FVector& OutBeamLocation);
+	/** Called when the FireButton action is invoked. ShotAge is how long before the end of this frame the shot was due */
+	void FireWeapon(float ShotAge = 0.f);
 
 	void AimingButtonPressed();
 	void AimingButtonReleased();
@@ -82,17 +123,30 @@ protected:
 	void FireButtonPressed();
 	void FireButtonReleased();
 
-	void StartFireTimer();
-	
-	UFUNCTION()
+	/** Starts the wait before the next automatic shot, less however long ago this shot was due */
+	void StartFireTimer(float ShotAge);
+
+	/** Fires every automatic shot that fell due within DeltaTime, so fire rate doesn't depend on frame rate */
+	void TickAutoFire(float DeltaTime);
+
+	/** Fires the next automatic shot if the trigger is still held, or ends the burst */
 	void AutoFireReset();
 	
 	/** Line trace for items under crosshairs */
 	bool TraceUnderCrosshairs(FHitResult& OutHitResult, FVector& OutHitLocation);
 
-	/** Trace for items is overlapperd item count is > 0*/
+	/** Deprojects the crosshairs into the world if not already done this frame. Returns true if the view is valid */
+	bool UpdateCrosshairView();
+
+	/** Updates bShouldTraceForItems from the pickup items near the character */
+	void UpdateNearbyItems();
+
+	/** Trace for items if there are pickup items nearby */
 	void TraceForItems();
 
+	/** Updates TraceHitItem and the pickup widgets from an item trace result */
+	void UpdateTraceHitItem(const FHitResult& ItemTraceResult);
+
 	/** Spawns and equips a default weapon */
 	class AWeapon* SpawnDefaultWeapon();
 
@@ -104,25 +158,41 @@ protected:
 
 	void SelectButtonPressed();
 
+	/** Picks up an item on the server for the owning client */
+	UFUNCTION(Server, Reliable)
+	void ServerSelectItem(AItem* Item);
+
 	void SelectButtonReleased();
 
+	/** Hides the local player's pickup widget */
+	void HidePickupWidget();
+
 	/** Drops currently equipped weapon and equips trace hit item*/
 	void SwapWeapon(AWeapon* WeaponToSwap);
 
-	/** Initialise the ammo map with starting values */
-	void InitialiseAmmoMap();
+	/** Initialise the inventory with starting ammo values */
+	void InitialiseAmmo();
+
+	/** Mirrors a change in carried ammo into the deprecated AmmoMap */
+	void HandleInventoryAmmoChanged(EAmmoType AmmoType, int32 Amount);
 
 	/** Check to make sure our weapon has ammo */
 	bool WeaponHasAmmo();
 	
 	/** Fire weapon functions*/
 	void PlayFireSound();
-	void SendBullet();
+	void SendBullet(float ShotAge, bool bMuzzleFlash);
+
+	/** Fills in the aim ray of a shot; the crosshairs when locally controlled, otherwise the next shot replayed from the owning client */
+	bool GetShotAim(struct FHitscanShotRequest& Shot);
+
+	/** Activates a pooled emitter for one of the firing particle systems */
+	class UParticleSystemComponent* SpawnShotEmitter(class UParticleSystem* Template, const FTransform& Transform);
 	void PlayGunFireMontage();
 
-	/** Reload functions*/
-	void ReloadButtonPressed();
-	void ReloadWeapon();
+	/** Asks the server to reload once it has replayed the shots already sent to it */
+	UFUNCTION(Server, Reliable)
+	void ServerReloadWeapon();
 
 	UFUNCTION(BlueprintCallable)
 	void FinishReloading();
@@ -137,6 +207,12 @@ protected:
 	/** Called from anim blueprint with ReleaseClip notifier*/
 	UFUNCTION(BlueprintCallable)
 	void ReleaseClip();
+
+	/** Sets up the mesh's update rate optimization the first time it is registered */
+	void OnAnimUpdateRateParamsCreated(FAnimUpdateRateParameters* Params);
+
+	/** Sets the anim evaluation rate for the current significance. Reloads run at full rate so the clip notifies land on time */
+	void ApplyAnimUpdateRate(FAnimUpdateRateParameters* Params) const;
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -193,11 +269,11 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Camera", meta = (AllowPrivateAccess = "true"), meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
 	float MouseAimingLookUpRate;
 
-	/** Randomised gunshot sound cue */
+	/** Randomised gunshot sound cue, for weapons whose definition has none */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
 	class USoundCue* FireSound;
 
-	/** Muzzle flash spawned at BarrelSocker */
+	/** Muzzle flash spawned at BarrelSocket, for weapons whose definition has none */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
 	class UParticleSystem* MuzzleFlash;
 
@@ -205,11 +281,11 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
 	class UAnimMontage* HipFireMontage;
 
-	/** Impact particles spawned on bullet impact */
+	/** Impact particles spawned on bullet impact, for weapons whose definition has none */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
 	UParticleSystem* ImpactParticles;
 
-	/** Smoke trail for bullets */
+	/** Smoke trail for bullets, for weapons whose definition has none */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (AllowPrivateAccess = "true"))
 	UParticleSystem* BeamParticles;
 
@@ -235,6 +311,9 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Crosshairs", meta = (AllowPrivateAccess = "true"))
 	float CrosshairSpreadMultiplier;
 
+	/** Crosshair spread last broadcast through OnCrosshairSpreadChanged */
+	float BroadcastCrosshairSpread;
+
 	/** Velocity component of the crosshair spread */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Crosshairs", meta = (AllowPrivateAccess = "true"))
 	float CrosshairVelocityFactor;
@@ -260,26 +339,47 @@ private:
 	/** Left mouse button or right trigger pressed */
 	bool bFireButtonPressed;
 
-	/** Rae of automatic weapon fire */
-	float AutomaticFireRate;
-	
-	/** Sets a timer between gunshots*/
-	FTimerHandle AutoFireTimer;
+	/** Time until the next automatic shot. Goes negative by however far into a frame the shot was due */
+	float FireCooldown;
+
+	/** Frame StartFireTimer last ran on */
+	uint64 FireTimerStartFrame;
+
+	/** Frame the last shot played its sound, muzzle flash and montage on */
+	uint64 LastShotCosmeticsFrame;
+
+	/** Sends automatic fire to the server in bursts and replays them there */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+	class UShooterFireBurstComponent* FireBurst;
+
+	/** Records hitbox history on the server so replayed shots hit where the client saw us */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+	class UShooterLagCompensationComponent* LagCompensation;
+
+	/** Detail tier assigned by UShooterSignificanceSubsystem */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Performance", meta = (AllowPrivateAccess = "true"))
+	EShooterSignificance Significance;
+
+	/** Server: the owning client reloaded while shots were still waiting to be replayed */
+	bool bServerReloadPending;
 
 	/** True if we should tarce every frame for items */
 	bool bShouldTraceForItems;
 
-	/** Number of overlapped AItems */
-	int8 OverlappedItemCount;
+	/** Handle of the async item trace issued last frame (Shooter.AsyncItemTrace) */
+	FTraceHandle ItemTraceHandle;
 
 	/** Keep a reference of the last AItem we traced*/
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Items", meta = (AllowPrivateAccess = "true"))
 	class AItem* TraceHitItemLastFrame;
 
 	/** Currently equipped weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Combat", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_EquippedWeapon, category = "Combat", meta = (AllowPrivateAccess = "true"))
 	AWeapon* EquippedWeapon;
 
+	UFUNCTION()
+	void OnRep_EquippedWeapon(AWeapon* OldWeapon);
+
 	/** Set this in blueprints for the default weapon class */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Combat", meta = (AllowPrivateAccess = "true"))
 	TSubclassOf<AWeapon> DefaultWeaponClass;
@@ -296,8 +396,12 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, category = "Items", meta = (AllowPrivateAccess = "true"))
 	float CameraInterpElevation;
 
-	/** Map to keep track of different ammo types */
+	/** Keeps track of carried ammo for each ammo type */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Items", meta = (AllowPrivateAccess = "true"))
+	class UShooterInventoryComponent* Inventory;
+
+	/** Copy of the carried ammo, kept in step with Inventory for blueprints that still read the old map (AmmoCount_BP) */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Items", meta = (AllowPrivateAccess = "true", DeprecatedProperty, DeprecationMessage = "Call GetAmmo on the Inventory component instead"))
 	TMap<EAmmoType, int32> AmmoMap;
 
 	/** Starting pistol ammo */
@@ -324,6 +428,13 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Combat", meta = (AllowPrivateAccess = "true"))
 	USceneComponent* HandSceneComponent;
 
+	/** Length of the line trace from the crosshairs */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Crosshairs", meta = (AllowPrivateAccess = "true"))
+	float CrosshairTraceLength;
+
+	/** This frame's crosshair query, shared by everything that needs to know what is under the crosshairs */
+	FCrosshairQuery CrosshairQuery;
+
 public:
 	/** Camera boom subobject*/
 	FORCEINLINE USpringArmComponent* GetCameraBoom() const { return CameraBoom; };
@@ -333,15 +444,51 @@ public:
 
 	FORCEINLINE bool GetAiming() const { return bAiming; };
 
-	UFUNCTION(BlueprintCallable)
-	float GetCrosshairSpreadMultiplier() const;
+	FORCEINLINE AWeapon* GetEquippedWeapon() const { return EquippedWeapon; };
+
+	FORCEINLINE UShooterFireBurstComponent* GetFireBurst() const { return FireBurst; };
 
-	FORCEINLINE int8 GetOverlappedItemCount() const { return OverlappedItemCount; };
+	FORCEINLINE UShooterInventoryComponent* GetInventory() const { return Inventory; };
 
-	/** Adds / subtracts to and from OverlappedItemCount and updates bShouldTraceForItems */
-	void IncrementOverlappedItemCount(int8 Amount);
+	FORCEINLINE EShooterSignificance GetSignificance() const { return Significance; };
+
+	/** True for the character of a player on this machine. AI controllers count as local on the server, so they're excluded */
+	FORCEINLINE bool IsLocalPlayerCharacter() const { return IsLocallyControlled() && IsPlayerControlled(); };
+
+	/** Applies a significance tier and the actor tick interval that goes with it */
+	void SetSignificance(EShooterSignificance NewSignificance, float TickInterval);
+
+	UFUNCTION(BlueprintCallable)
+	float GetCrosshairSpreadMultiplier() const;
 
 	FVector GetCameraInterpLocation();
 
 	void GetPickupItem(AItem* Item);
+
+	/** Returns this frame's crosshair query, tracing at most once per frame */
+	const FCrosshairQuery& GetCrosshairQuery();
+
+	/** Called by the hitscan subsystem once a shot we fired has been resolved */
+	void OnShotResolved(const struct FHitscanShotResult& Result);
+
+	/** Server: starts firing shots received from the owning client if not already busy */
+	void StartBurstReplay();
+
+	/** Holds or releases the fire button, for scripted drivers such as benchmarks */
+	void SetFireButtonHeld(bool bHeld);
+
+	/** Starts a reload if unoccupied and carrying ammo for the equipped weapon */
+	void ReloadWeapon();
+
+	/** Handles the reload button, for scripted drivers such as bots as well as player input */
+	void ReloadButtonPressed();
+
+	/** Selects a pickup item as if it were under the crosshairs, for scripted drivers such as bots */
+	void SelectItem(AItem* Item);
+
+	/** Samples this frame's bound axes and action presses from the player input, for input recording */
+	void CaptureInputFrame(struct FShooterInputFrame& Frame) const;
+
+	/** Feeds a recorded frame through the same handlers SetupPlayerInputComponent binds */
+	void ApplyInputFrame(const struct FShooterInputFrame& Frame);
 };
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterEmitterPoolSubsystem.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Engine/World.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Emitter Spawns"), STAT_EmitterSpawns, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Emitter Pool Hits"), STAT_EmitterPoolHits, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Emitter Pool Misses"), STAT_EmitterPoolMisses, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Emitter Pool Evictions"), STAT_EmitterPoolEvictions, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Emitter Pool Size"), STAT_EmitterPoolSize, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Emitter Pool Largest Template Peak"), STAT_EmitterPoolPeakUsage, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarEmitterPoolCap(
+	TEXT("Shooter.EmitterPoolCap"),
+	32,
+	TEXT("Maximum number of pooled emitter components per particle template. When reached, the oldest emitter is restarted."),
+	ECVF_Default);
+
+bool UShooterEmitterPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if UE_SERVER
+	return false;
+#else
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+#endif
+}
+
+void UShooterEmitterPoolSubsystem::Deinitialize()
+{
+	for (auto& Pair : Pools)
+	{
+		UE_LOG(LogShooter, Log, TEXT("Emitter pool %s: %d components, peak %d active"),
+			*GetNameSafe(Pair.Key), Pair.Value.Components.Num(), Pair.Value.PeakUsage);
+
+		for (UParticleSystemComponent* Component : Pair.Value.Components)
+		{
+			if (Component)
+			{
+				Component->DestroyComponent();
+				DEC_DWORD_STAT(STAT_EmitterPoolSize);
+			}
+		}
+	}
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+UParticleSystemComponent* UShooterEmitterPoolSubsystem::SpawnEmitter(UParticleSystem* Template, const FTransform& Transform)
+{
+	if (Template == nullptr) return nullptr;
+
+	INC_DWORD_STAT(STAT_EmitterSpawns);
+	CSV_CUSTOM_STAT(Shooter, EmitterSpawns, 1, ECsvCustomStatOp::Accumulate);
+
+	FShooterEmitterPool& Pool = Pools.FindOrAdd(Template);
+	const int32 PoolCap = FMath::Max(1, CVarEmitterPoolCap.GetValueOnGameThread());
+
+	// Look for a finished emitter, keeping track of the oldest one in case all are busy
+	int32 FreeIndex = INDEX_NONE;
+	int32 OldestIndex = INDEX_NONE;
+	int32 NumActive = 0;
+	for (int32 Index = 0; Index < Pool.Components.Num(); ++Index)
+	{
+		UParticleSystemComponent* Component = Pool.Components[Index];
+		if (Component == nullptr) continue;
+
+		if (Component->IsActive())
+		{
+			++NumActive;
+			if (OldestIndex == INDEX_NONE || Pool.ActivationTimes[Index] < Pool.ActivationTimes[OldestIndex])
+			{
+				OldestIndex = Index;
+			}
+		}
+		else if (FreeIndex == INDEX_NONE)
+		{
+			FreeIndex = Index;
+		}
+	}
+
+	int32 UseIndex = FreeIndex;
+	if (UseIndex != INDEX_NONE)
+	{
+		INC_DWORD_STAT(STAT_EmitterPoolHits);
+	}
+	else if (Pool.Components.Num() < PoolCap || OldestIndex == INDEX_NONE)
+	{
+		INC_DWORD_STAT(STAT_EmitterPoolMisses);
+		UseIndex = Pool.Components.Add(CreateComponent(Template));
+		Pool.ActivationTimes.Add(0.f);
+	}
+	else
+	{
+		// Pool is full, drop the oldest emitter and restart it here
+		INC_DWORD_STAT(STAT_EmitterPoolEvictions);
+		UseIndex = OldestIndex;
+		--NumActive;
+	}
+
+	UParticleSystemComponent* Component = Pool.Components[UseIndex];
+	Pool.ActivationTimes[UseIndex] = GetWorld()->GetTimeSeconds();
+	Component->SetWorldTransform(Transform);
+	Component->ActivateSystem(true);
+
+	Pool.PeakUsage = FMath::Max(Pool.PeakUsage, NumActive + 1);
+	if (Pool.PeakUsage > LargestPeakUsage)
+	{
+		LargestPeakUsage = Pool.PeakUsage;
+		SET_DWORD_STAT(STAT_EmitterPoolPeakUsage, LargestPeakUsage);
+	}
+	return Component;
+}
+
+UParticleSystemComponent* UShooterEmitterPoolSubsystem::CreateComponent(UParticleSystem* Template)
+{
+	UWorld* World = GetWorld();
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(World);
+	Component->bAutoActivate = false;
+	Component->bAutoDestroy = false;
+	Component->SetUsingAbsoluteLocation(true);
+	Component->SetUsingAbsoluteRotation(true);
+	Component->SetUsingAbsoluteScale(true);
+	Component->SetTemplate(Template);
+	Component->RegisterComponentWithWorld(World);
+
+	INC_DWORD_STAT(STAT_EmitterPoolSize);
+	return Component;
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterEmitterPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/** Pre-registered emitter components for a single particle template */
+USTRUCT()
+struct FShooterEmitterPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Components;
+
+	/** World time each component in Components was last activated, used to find the oldest */
+	TArray<float> ActivationTimes;
+
+	/** Highest number of emitters of this template active at once */
+	int32 PeakUsage = 0;
+};
+
+/**
+ * Per-world pool of particle system components keyed by template. Components are
+ * reactivated rather than spawned, so firing does not create and destroy UObjects.
+ * When a template's pool is at Shooter.EmitterPoolCap the oldest emitter is restarted.
+ */
+UCLASS()
+class SHOOTER_API UShooterEmitterPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Dedicated servers never draw particles, so they get no pool */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	/** Activates a pooled emitter for Template at Transform. The returned component must not be kept hold of */
+	UParticleSystemComponent* SpawnEmitter(UParticleSystem* Template, const FTransform& Transform);
+
+private:
+	/** Creates and registers a new component for Template, not yet activated */
+	UParticleSystemComponent* CreateComponent(UParticleSystem* Template);
+
+	UPROPERTY()
+	TMap<UParticleSystem*, FShooterEmitterPool> Pools;
+
+	/** Highest PeakUsage of any one template's pool */
+	int32 LargestPeakUsage = 0;
+};
@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterFireBurstComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "Serialization/BitWriter.h"
+#include "ShooterCharacter.h"
+#include "Weapon.h"
+#include "ShooterLagCompensationSubsystem.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Burst RPCs"), STAT_FireBurstRPCs, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Burst Bytes"), STAT_FireBurstBytes, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fire Burst Shots"), STAT_FireBurstShots, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarFireBurstWindow(
+	TEXT("Shooter.FireBurstWindow"),
+	0.2f,
+	TEXT("Longest time in seconds a client holds recorded shots before sending them to the server.\n")
+	TEXT("Bursts are also sent when the fire button is released or FShooterFireBurst::MaxShots is reached."),
+	ECVF_Default);
+
+/** Extra time allowed when checking a burst against the weapon's fire rate, covers timer jitter */
+static const float FireBurstRateTolerance = 0.25f;
+
+bool FShooterFireBurst::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << StartTime;
+	AimOriginOffset.NetSerialize(Ar, Map, bOutSuccess);
+
+	uint32 NumAims = FMath::Min(Aims.Num(), MaxShots);
+	Ar.SerializeInt(NumAims, MaxShots + 1);
+	if (Ar.IsLoading())
+	{
+		Aims.SetNumUninitialized(NumAims);
+	}
+	for (uint32 i = 0; i < NumAims; i++)
+	{
+		Ar << Aims[i];
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+uint32 FShooterFireBurst::QuantizeAim(const FVector& Direction)
+{
+	const FRotator Rotation = Direction.Rotation();
+	return (static_cast<uint32>(FRotator::CompressAxisToShort(Rotation.Yaw)) << 16) | FRotator::CompressAxisToShort(Rotation.Pitch);
+}
+
+FVector FShooterFireBurst::DequantizeAim(uint32 Aim)
+{
+	const float Yaw = FRotator::DecompressAxisFromShort(static_cast<uint16>(Aim >> 16));
+	const float Pitch = FRotator::DecompressAxisFromShort(static_cast<uint16>(Aim & 0xFFFF));
+	return FRotator(Pitch, Yaw, 0.f).Vector();
+}
+
+UShooterFireBurstComponent::UShooterFireBurstComponent() :
+	ShooterOwner(nullptr),
+	PendingBurstStartTime(0.f),
+	ReplayIndex(0),
+	ServerNextShotTime(0.f),
+	NetBytes(0),
+	NetBursts(0),
+	NetShots(0),
+	NetStatsStartTime(0.f)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void UShooterFireBurstComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ShooterOwner = Cast<AShooterCharacter>(GetOwner());
+	ResetNetStats();
+}
+
+void UShooterFireBurstComponent::RecordShot(const FVector& AimOrigin, const FVector& AimDirection, float ShotAge)
+{
+	if (ShooterOwner == nullptr) return;
+
+	if (PendingBurst.Aims.Num() == 0)
+	{
+		PendingBurst.StartTime = GetServerWorldTime() - ShotAge;
+		PendingBurst.AimOriginOffset = AimOrigin - ShooterOwner->GetActorLocation();
+		PendingBurstStartTime = GetWorld()->GetTimeSeconds();
+	}
+	PendingBurst.Aims.Add(FShooterFireBurst::QuantizeAim(AimDirection));
+
+	const bool bWindowElapsed = GetWorld()->GetTimeSeconds() - PendingBurstStartTime >= CVarFireBurstWindow.GetValueOnGameThread();
+	if (bWindowElapsed || PendingBurst.Aims.Num() >= FShooterFireBurst::MaxShots)
+	{
+		FlushBurst();
+	}
+}
+
+void UShooterFireBurstComponent::FlushBurst()
+{
+	if (PendingBurst.Aims.Num() == 0) return;
+
+	const int32 BurstSize = GetBurstSize(PendingBurst);
+	NetBytes += BurstSize;
+	NetBursts++;
+	NetShots += PendingBurst.Aims.Num();
+	INC_DWORD_STAT(STAT_FireBurstRPCs);
+	INC_DWORD_STAT_BY(STAT_FireBurstBytes, BurstSize);
+	INC_DWORD_STAT_BY(STAT_FireBurstShots, PendingBurst.Aims.Num());
+
+	ServerFireBurst(PendingBurst);
+	PendingBurst.Aims.Reset();
+}
+
+bool UShooterFireBurstComponent::ServerFireBurst_Validate(const FShooterFireBurst& Burst)
+{
+	return Burst.Aims.Num() <= FShooterFireBurst::MaxShots;
+}
+
+void UShooterFireBurstComponent::ServerFireBurst_Implementation(const FShooterFireBurst& Burst)
+{
+	if (ShooterOwner == nullptr) return;
+
+	NetBytes += GetBurstSize(Burst);
+	NetBursts++;
+
+	const AWeapon* Weapon = ShooterOwner->GetEquippedWeapon();
+	const UWeaponDefinition* WeaponDefinition = Weapon ? Weapon->GetWeaponDefinition() : nullptr;
+	const float FireRate = WeaponDefinition ? WeaponDefinition->GetAutomaticFireRate() : 0.1f;
+
+	// The client's start time is only trusted as far back as a shot can be rewound, and never into the future
+	const float Now = GetServerWorldTime();
+	const float StartTime = FMath::Clamp(Burst.StartTime, Now - UShooterLagCompensationSubsystem::GetMaxRewindTime(), Now);
+
+	// Drop shots that have already been replayed before queueing more
+	if (ReplayIndex > 0)
+	{
+		ReplayShots.RemoveAt(0, ReplayIndex, false);
+		ReplayIndex = 0;
+	}
+
+	// Shots are credited one fire interval apart, carrying on from the last burst's final shot however the client
+	// splits or dates its bursts. Shots that would be credited later than now are more than the weapon can fire
+	float ShotTime = FMath::Max(StartTime, ServerNextShotTime);
+	int32 NumShots = 0;
+	for (; NumShots < Burst.Aims.Num(); NumShots++)
+	{
+		if (FireRate > 0.f && ShotTime > Now + FireBurstRateTolerance) break;
+
+		ReplayShots.Add({ Burst.AimOriginOffset, FShooterFireBurst::DequantizeAim(Burst.Aims[NumShots]), ShotTime });
+		ShotTime += FireRate;
+	}
+	ServerNextShotTime = ShotTime;
+	NetShots += NumShots;
+
+	// Don't let shots pile up if the server can't fire them (e.g. it has no ammo to reload with)
+	ReplayIndex = FMath::Max(ReplayIndex, ReplayShots.Num() - FShooterFireBurst::MaxShots);
+
+	ShooterOwner->StartBurstReplay();
+}
+
+bool UShooterFireBurstComponent::PopReplayShot(FVector& OutAimOrigin, FVector& OutAimDirection, float& OutShotTime)
+{
+	if (!HasReplayShots() || ShooterOwner == nullptr) return false;
+
+	const FShooterReplayShot& Shot = ReplayShots[ReplayIndex++];
+	OutAimOrigin = ShooterOwner->GetActorLocation() + Shot.AimOriginOffset;
+	OutAimDirection = Shot.AimDirection;
+	OutShotTime = Shot.ShotTime;
+	return true;
+}
+
+int32 UShooterFireBurstComponent::GetBurstSize(const FShooterFireBurst& Burst)
+{
+	FBitWriter Writer(0, true);
+	bool bSuccess = true;
+	const_cast<FShooterFireBurst&>(Burst).NetSerialize(Writer, nullptr, bSuccess);
+	return Writer.GetNumBytes();
+}
+
+float UShooterFireBurstComponent::GetServerWorldTime() const
+{
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+void UShooterFireBurstComponent::ResetNetStats()
+{
+	NetBytes = 0;
+	NetBursts = 0;
+	NetShots = 0;
+	NetStatsStartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UShooterFireBurstComponent::LogNetStats() const
+{
+	const float Elapsed = FMath::Max(GetWorld()->GetTimeSeconds() - NetStatsStartTime, KINDA_SMALL_NUMBER);
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	const FString Direction = GetOwnerRole() == ROLE_Authority ? TEXT("received from") : TEXT("sent by");
+
+	UE_LOG(LogShooter, Display, TEXT("Fire bursts %s %s over %.1fs: %.1f bytes/s, %.2f RPCs/s, %.1f shots/s"),
+		*Direction, Pawn && Pawn->GetPlayerState() ? *Pawn->GetPlayerState()->GetPlayerName() : *GetOwner()->GetName(),
+		Elapsed, NetBytes / Elapsed, NetBursts / Elapsed, NetShots / Elapsed);
+}
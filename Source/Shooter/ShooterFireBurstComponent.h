@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "ShooterFireBurstComponent.generated.h"
+
+/** One burst of automatic fire sent from the owning client to the server in a single RPC */
+USTRUCT()
+struct FShooterFireBurst
+{
+	GENERATED_BODY()
+
+	/** Most shots a single burst can carry, bounds the bits used for the shot count */
+	static constexpr int32 MaxShots = 64;
+
+	/** Server world time the first shot of the burst was fired at, as claimed by the client */
+	float StartTime = 0.f;
+
+	/** Offset of the crosshair view origin from the character when the burst started */
+	FVector_NetQuantize10 AimOriginOffset;
+
+	/** One aim per shot, yaw and pitch compressed to 16 bits each */
+	TArray<uint32> Aims;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	static uint32 QuantizeAim(const FVector& Direction);
+	static FVector DequantizeAim(uint32 Aim);
+};
+
+template<>
+struct TStructOpsTypeTraits<FShooterFireBurst> : public TStructOpsTypeTraitsBase2<FShooterFireBurst>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/** A shot received from the owning client, waiting for the server to replay it */
+struct FShooterReplayShot
+{
+	FVector AimOriginOffset;
+	FVector AimDirection;
+
+	/** Server time the client fired the shot at, for lag compensation */
+	float ShotTime;
+};
+
+/**
+ * Networks automatic fire as bursts. The owning client records the aim of every shot it fires and sends
+ * them in one RPC per burst (or per Shooter.FireBurstWindow seconds of a long burst). The server queues
+ * the shots and its character replays them on its own AutoFireTimer cadence.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SHOOTER_API UShooterFireBurstComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterFireBurstComponent();
+
+	/** Client: records a shot fired along the crosshairs ShotAge seconds ago, flushing the burst if its window is full */
+	void RecordShot(const FVector& AimOrigin, const FVector& AimDirection, float ShotAge = 0.f);
+
+	/** Client: sends any recorded shots to the server */
+	void FlushBurst();
+
+	/** Server: true if there are received shots still to replay */
+	FORCEINLINE bool HasReplayShots() const { return ReplayIndex < ReplayShots.Num(); };
+
+	/** Server: takes the next received shot to replay, returning its aim in world space and when the client fired it */
+	bool PopReplayShot(FVector& OutAimOrigin, FVector& OutAimDirection, float& OutShotTime);
+
+	/** Clears the bandwidth counters */
+	void ResetNetStats();
+
+	/** Logs burst bytes, RPCs and shots per second since the counters were reset */
+	void LogNetStats() const;
+
+protected:
+	virtual void BeginPlay() override;
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFireBurst(const FShooterFireBurst& Burst);
+
+private:
+	/** Bytes FShooterFireBurst::NetSerialize writes for this burst */
+	static int32 GetBurstSize(const FShooterFireBurst& Burst);
+
+	/** Current world time as seen by the server */
+	float GetServerWorldTime() const;
+
+	/** Character that owns this component */
+	UPROPERTY()
+	class AShooterCharacter* ShooterOwner;
+
+	/** Client: shots recorded since the last flush */
+	FShooterFireBurst PendingBurst;
+
+	/** Client: world time the pending burst started at */
+	float PendingBurstStartTime;
+
+	/** Server: received shots in fire order, consumed from ReplayIndex */
+	TArray<FShooterReplayShot> ReplayShots;
+	int32 ReplayIndex;
+
+	/** Server: earliest time the client's next shot can be credited at, carried across bursts to cap the fire rate */
+	float ServerNextShotTime;
+
+	/** Bandwidth counters, bytes and RPCs are sent on clients and received on the server */
+	int64 NetBytes;
+	int32 NetBursts;
+	int32 NetShots;
+	float NetStatsStartTime;
+};
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterHUDOverlay.h"
+#include "Widgets/SInvalidationPanel.h"
+#include "Slate/SRetainerWidget.h"
+#include "ShooterCharacter.h"
+#include "ShooterInventoryComponent.h"
+#include "Weapon.h"
+
+static TAutoConsoleVariable<int32> CVarHUDRetainer(
+	TEXT("Shooter.HUD.Retainer"),
+	0,
+	TEXT("If non-zero, the HUD overlay renders into a retainer texture that is only redrawn when the HUD changes, rather than caching under an invalidation panel. Takes effect when the HUD is next created."),
+	ECVF_Default);
+
+TSharedRef<SWidget> UShooterHUDOverlay::RebuildWidget()
+{
+	TSharedRef<SWidget> Content = Super::RebuildWidget();
+
+	// A blueprint still using property bindings has to be painted every frame to pick them up
+	if (!bCacheUnderInvalidation) return Content;
+
+	if (CVarHUDRetainer.GetValueOnGameThread() != 0)
+	{
+		return SNew(SRetainerWidget)
+			.RenderOnPhase(false)
+			.RenderOnInvalidation(true)
+			.StatId(TEXT("ShooterHUDOverlay"))
+			[
+				Content
+			];
+	}
+
+	return SNew(SInvalidationPanel)
+		.DebugName(TEXT("ShooterHUDOverlay"))
+		[
+			Content
+		];
+}
+
+void UShooterHUDOverlay::NativeDestruct()
+{
+	SetCharacter(nullptr);
+	Super::NativeDestruct();
+}
+
+void UShooterHUDOverlay::SetCharacter(AShooterCharacter* NewCharacter)
+{
+	if (Character == NewCharacter) return;
+
+	if (Character)
+	{
+		Character->OnEquipWeapon.Remove(EquipWeaponHandle);
+		Character->OnCrosshairSpreadChanged.Remove(CrosshairSpreadHandle);
+		if (UShooterInventoryComponent* Inventory = Character->GetInventory())
+		{
+			Inventory->OnAmmoChanged.Remove(InventoryAmmoHandle);
+		}
+	}
+
+	Character = NewCharacter;
+
+	if (Character)
+	{
+		EquipWeaponHandle = Character->OnEquipWeapon.AddUObject(this, &UShooterHUDOverlay::HandleEquipWeapon);
+		CrosshairSpreadHandle = Character->OnCrosshairSpreadChanged.AddUObject(this, &UShooterHUDOverlay::HandleCrosshairSpreadChanged);
+		if (UShooterInventoryComponent* Inventory = Character->GetInventory())
+		{
+			InventoryAmmoHandle = Inventory->OnAmmoChanged.AddUObject(this, &UShooterHUDOverlay::HandleInventoryAmmoChanged);
+		}
+	}
+
+	HandleCrosshairSpreadChanged(Character ? Character->GetCrosshairSpreadMultiplier() : 0.f);
+	SetWeapon(Character ? Character->GetEquippedWeapon() : nullptr);
+}
+
+void UShooterHUDOverlay::SetWeapon(AWeapon* NewWeapon)
+{
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->OnAmmoChanged.Remove(WeaponAmmoHandle);
+	}
+
+	EquippedWeapon = NewWeapon;
+
+	if (EquippedWeapon)
+	{
+		WeaponAmmoHandle = EquippedWeapon->OnAmmoChanged.AddUObject(this, &UShooterHUDOverlay::HandleWeaponAmmoChanged);
+	}
+
+	const UShooterInventoryComponent* Inventory = Character ? Character->GetInventory() : nullptr;
+	AmmoCount = EquippedWeapon ? EquippedWeapon->GetAmmoCount() : 0;
+	MagazineCapacity = EquippedWeapon ? EquippedWeapon->GetMagazineCapacity() : 0;
+	CarriedAmmo = EquippedWeapon && Inventory ? Inventory->GetAmmo(EquippedWeapon->GetAmmoType()) : 0;
+
+	OnWeaponChanged();
+	OnAmmoChanged();
+}
+
+void UShooterHUDOverlay::HandleEquipWeapon(AShooterCharacter* InCharacter, AWeapon* NewWeapon, AWeapon* OldWeapon)
+{
+	if (NewWeapon != EquippedWeapon)
+	{
+		SetWeapon(NewWeapon);
+	}
+}
+
+void UShooterHUDOverlay::HandleCrosshairSpreadChanged(float NewCrosshairSpreadMultiplier)
+{
+	CrosshairSpreadMultiplier = NewCrosshairSpreadMultiplier;
+	OnCrosshairSpreadChanged();
+}
+
+void UShooterHUDOverlay::HandleWeaponAmmoChanged(AWeapon* Weapon)
+{
+	if (Weapon != EquippedWeapon || Weapon->GetAmmoCount() == AmmoCount) return;
+
+	AmmoCount = Weapon->GetAmmoCount();
+	OnAmmoChanged();
+}
+
+void UShooterHUDOverlay::HandleInventoryAmmoChanged(EAmmoType AmmoType, int32 Amount)
+{
+	if (EquippedWeapon == nullptr || EquippedWeapon->GetAmmoType() != AmmoType || Amount == CarriedAmmo) return;
+
+	CarriedAmmo = Amount;
+	OnAmmoChanged();
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "AmmoType.h"
+#include "ShooterHUDOverlay.generated.h"
+
+class AShooterCharacter;
+class AWeapon;
+
+/**
+ * Base class for the screen HUD overlay. Holds the values the HUD shows and updates them from
+ * delegates on the character, its weapon and its inventory only when they change, so blueprint
+ * updates its widgets from the On...Changed events rather than through per-frame property bindings.
+ * Once it does, bCacheUnderInvalidation caches the widget tree under an invalidation panel, so it is
+ * only laid out and painted again when one of those events changes something.
+ */
+UCLASS()
+class SHOOTER_API UShooterHUDOverlay : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/** Points the HUD at the character the player is controlling, or nullptr */
+	void SetCharacter(AShooterCharacter* NewCharacter);
+
+protected:
+	virtual TSharedRef<SWidget> RebuildWidget() override;
+	virtual void NativeDestruct() override;
+
+	/** Called when the ammo in the magazine or carried for the equipped weapon changes */
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnAmmoChanged();
+
+	/** Called when the crosshair spread changes */
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnCrosshairSpreadChanged();
+
+	/** Called when the character equips a different weapon */
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnWeaponChanged();
+
+	/**
+	 * Caches the widget tree under an invalidation panel, or a retainer with Shooter.HUD.Retainer. Only set this once
+	 * every property binding has been replaced by the On...Changed events, as bound values stop updating under the cache
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+	bool bCacheUnderInvalidation = false;
+
+private:
+	/** Rebinds to the ammo of a newly equipped weapon */
+	void SetWeapon(AWeapon* NewWeapon);
+
+	void HandleEquipWeapon(AShooterCharacter* InCharacter, AWeapon* NewWeapon, AWeapon* OldWeapon);
+	void HandleCrosshairSpreadChanged(float NewCrosshairSpreadMultiplier);
+	void HandleWeaponAmmoChanged(AWeapon* Weapon);
+	void HandleInventoryAmmoChanged(EAmmoType AmmoType, int32 Amount);
+
+	/** Character the HUD is showing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD", meta = (AllowPrivateAccess = "true"))
+	AShooterCharacter* Character;
+
+	/** Weapon the character has equipped */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD", meta = (AllowPrivateAccess = "true"))
+	AWeapon* EquippedWeapon;
+
+	/** Rounds in the equipped weapon's magazine */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD", meta = (AllowPrivateAccess = "true"))
+	int32 AmmoCount;
+
+	/** Rounds the equipped weapon's magazine holds */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD", meta = (AllowPrivateAccess = "true"))
+	int32 MagazineCapacity;
+
+	/** Ammo carried of the equipped weapon's type */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD", meta = (AllowPrivateAccess = "true"))
+	int32 CarriedAmmo;
+
+	/** Spread of the crosshairs */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD", meta = (AllowPrivateAccess = "true"))
+	float CrosshairSpreadMultiplier;
+
+	FDelegateHandle EquipWeaponHandle;
+	FDelegateHandle CrosshairSpreadHandle;
+	FDelegateHandle InventoryAmmoHandle;
+	FDelegateHandle WeaponAmmoHandle;
+};
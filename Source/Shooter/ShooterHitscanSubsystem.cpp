@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterHitscanSubsystem.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "ShooterCharacter.h"
+#include "ShooterLagCompensationSubsystem.h"
+#include "ShooterLagCompensationComponent.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Batch Size"), STAT_HitscanBatchSize, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Hitscan Resolve"), STAT_HitscanResolve, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarHitscanParallelThreshold(
+	TEXT("Shooter.HitscanParallelThreshold"),
+	4,
+	TEXT("Minimum number of shots in a frame before the hitscan batch is spread across worker threads."),
+	ECVF_Default);
+
+void UShooterHitscanSubsystem::QueueShot(const FHitscanShotRequest& Shot)
+{
+	PendingShots.Add(Shot);
+}
+
+void UShooterHitscanSubsystem::ResolveShot(const UWorld* World, const FHitscanShotRequest& Shot, FHitscanShotResult& OutResult,
+	const UShooterLagCompensationSubsystem* LagCompensation, const TArray<AActor*>* CompensatedActors)
+{
+	const bool bRewind = LagCompensation && Shot.RewindTime >= 0.f;
+	const AActor* Instigator = Shot.Instigator.Get();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(HitscanShot));
+	if (bRewind && CompensatedActors)
+	{
+		// Characters are tested at their rewound pose rather than where they are now
+		QueryParams.AddIgnoredActors(*CompensatedActors);
+	}
+
+	OutResult.WeaponDefinition = Shot.WeaponDefinition;
+	OutResult.MuzzleTransform = Shot.MuzzleTransform;
+	OutResult.BeamEnd = Shot.AimEnd;
+	OutResult.bHit = false;
+	OutResult.Hit = FHitResult();
+
+	if (!Shot.bAimTraced)
+	{
+		// Tentative beam location from the crosshairs. Still need to trace from barrel
+		FHitResult AimHit;
+		if (World->LineTraceSingleByChannel(AimHit, Shot.AimStart, Shot.AimEnd, ECollisionChannel::ECC_Visibility, QueryParams))
+		{
+			OutResult.BeamEnd = AimHit.Location;
+		}
+
+		FShooterRewindHit AimRewindHit;
+		AimRewindHit.Distance = AimHit.bBlockingHit ? AimHit.Distance : BIG_NUMBER;
+		if (bRewind && LagCompensation->TraceRewound(Shot.RewindTime, Shot.AimStart, Shot.AimEnd, Instigator, AimRewindHit))
+		{
+			OutResult.BeamEnd = AimRewindHit.Location;
+		}
+	}
+
+	// Perform trace from gun barrel
+	const FVector MuzzleLocation(Shot.MuzzleTransform.GetLocation());
+	const FVector StartToEnd(OutResult.BeamEnd - MuzzleLocation);
+	const FVector WeaponTraceEnd(MuzzleLocation + StartToEnd * 1.25f);
+	World->LineTraceSingleByChannel(OutResult.Hit, MuzzleLocation, WeaponTraceEnd, ECollisionChannel::ECC_Visibility, QueryParams);
+
+	FShooterRewindHit RewindHit;
+	RewindHit.Distance = OutResult.Hit.bBlockingHit ? OutResult.Hit.Distance : BIG_NUMBER;
+	if (bRewind && LagCompensation->TraceRewound(Shot.RewindTime, MuzzleLocation, WeaponTraceEnd, Instigator, RewindHit))
+	{
+		// A rewound character is in front of anything the world trace hit
+		OutResult.Hit = FHitResult(RewindHit.Actor, nullptr, RewindHit.Location, (MuzzleLocation - WeaponTraceEnd).GetSafeNormal());
+		OutResult.Hit.bBlockingHit = true;
+		OutResult.Hit.BoneName = RewindHit.BoneName;
+		OutResult.Hit.Distance = RewindHit.Distance;
+		OutResult.Hit.TraceStart = MuzzleLocation;
+		OutResult.Hit.TraceEnd = WeaponTraceEnd;
+	}
+
+	if (OutResult.Hit.bBlockingHit)
+	{
+		// Object between barrel and beam endpoint
+		OutResult.BeamEnd = OutResult.Hit.Location;
+		OutResult.bHit = true;
+	}
+}
+
+void UShooterHitscanSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_HitscanResolve);
+	CSV_SCOPED_TIMING_STAT(Shooter, HitscanResolve);
+
+	const int32 NumShots = PendingShots.Num();
+	INC_DWORD_STAT_BY(STAT_HitscanBatchSize, NumShots);
+	CSV_CUSTOM_STAT(Shooter, ShotsResolved, NumShots, ECsvCustomStatOp::Set);
+
+	// Scene queries are safe to run concurrently once physics has finished for the frame
+	const UWorld* World = GetWorld();
+	const UShooterLagCompensationSubsystem* LagCompensation = World->GetSubsystem<UShooterLagCompensationSubsystem>();
+	CompensatedActors.Reset();
+	if (LagCompensation)
+	{
+		LagCompensation->GetCompensatedActors(CompensatedActors);
+	}
+
+	Results.SetNum(NumShots, false);
+	ParallelFor(NumShots, [this, World, LagCompensation](int32 Index)
+	{
+		ResolveShot(World, PendingShots[Index], Results[Index], LagCompensation, &CompensatedActors);
+	}, NumShots < CVarHitscanParallelThreshold.GetValueOnGameThread());
+
+	// Hand results back on the game thread
+	for (int32 Index = 0; Index < NumShots; ++Index)
+	{
+		AShooterCharacter* Instigator = PendingShots[Index].Instigator.Get();
+		if (Instigator)
+		{
+			Instigator->OnShotResolved(Results[Index]);
+		}
+	}
+
+	PendingShots.Reset();
+}
+
+bool UShooterHitscanSubsystem::IsTickable() const
+{
+	return PendingShots.Num() > 0;
+}
+
+ETickableTickType UShooterHitscanSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UShooterHitscanSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UShooterHitscanSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterHitscanSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterHitscanSubsystem.generated.h"
+
+class AShooterCharacter;
+class UWeaponDefinition;
+class UShooterLagCompensationSubsystem;
+
+/** A single shot waiting to be resolved with the rest of this frame's batch */
+struct FHitscanShotRequest
+{
+	/** Character that fired the shot, results are handed back to it */
+	TWeakObjectPtr<AShooterCharacter> Instigator;
+
+	/** Definition of the weapon that fired, used for impact FX */
+	const UWeaponDefinition* WeaponDefinition = nullptr;
+
+	/** Transform of the weapon's barrel socket when the shot was fired */
+	FTransform MuzzleTransform;
+
+	/** Aim ray from the crosshairs outwards */
+	FVector AimStart = FVector::ZeroVector;
+	FVector AimEnd = FVector::ZeroVector;
+
+	/** True if AimEnd is already the crosshair hit location, so the aim ray does not need tracing again */
+	bool bAimTraced = false;
+
+	/** Seconds before the end of the frame the shot was fired at, when several shots fall within one frame */
+	float ShotAge = 0.f;
+
+	/** Server time the shooter fired at. Characters are tested at their pose from then. Negative to test them as they are now */
+	float RewindTime = -1.f;
+};
+
+/** Outcome of a resolved shot */
+struct FHitscanShotResult
+{
+	/** Definition of the weapon that fired */
+	const UWeaponDefinition* WeaponDefinition = nullptr;
+
+	/** Transform of the barrel socket the shot was fired from */
+	FTransform MuzzleTransform;
+
+	/** Where the beam from the barrel ends */
+	FVector BeamEnd = FVector::ZeroVector;
+
+	/** True if the trace from the barrel hit something */
+	bool bHit = false;
+
+	/** Hit from the barrel trace */
+	FHitResult Hit;
+};
+
+/**
+ * Collects every shot fired in the world during a frame and resolves them together as one batch,
+ * spread across worker threads, then hands the results back to the instigating characters.
+ */
+UCLASS()
+class SHOOTER_API UShooterHitscanSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Queues a shot to be resolved at the end of this frame */
+	void QueueShot(const FHitscanShotRequest& Shot);
+
+	/**
+	 * Traces a single shot. Safe to call from worker threads.
+	 * Shots with a RewindTime ignore CompensatedActors in world traces and test their rewound hitboxes instead.
+	 */
+	static void ResolveShot(const UWorld* World, const FHitscanShotRequest& Shot, FHitscanShotResult& OutResult,
+		const UShooterLagCompensationSubsystem* LagCompensation = nullptr, const TArray<AActor*>* CompensatedActors = nullptr);
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Shots queued this frame */
+	TArray<FHitscanShotRequest> PendingShots;
+
+	/** Results for PendingShots, kept around to avoid reallocating every frame */
+	TArray<FHitscanShotResult> Results;
+
+	/** Lag-compensated characters, gathered once per batch */
+	TArray<AActor*> CompensatedActors;
+};
@@ -0,0 +1,320 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterInputReplaySubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "HAL/IConsoleManager.h"
+#include "RenderCore.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+
+/** "SHIR" */
+static const uint32 InputRecordingMagic = 0x52494853;
+static const int32 InputRecordingVersion = 2;
+
+FArchive& operator<<(FArchive& Ar, FShooterInputFrame& Frame)
+{
+	uint8 AxisMask = 0;
+	if (Ar.IsSaving())
+	{
+		for (int32 Axis = 0; Axis < static_cast<int32>(EShooterInputAxis::MAX); Axis++)
+		{
+			if (Frame.Axes[Axis] != 0.f)
+			{
+				AxisMask |= 1 << Axis;
+			}
+		}
+	}
+	Ar << AxisMask;
+
+	for (int32 Axis = 0; Axis < static_cast<int32>(EShooterInputAxis::MAX); Axis++)
+	{
+		if (AxisMask & (1 << Axis))
+		{
+			Ar << Frame.Axes[Axis];
+		}
+		else
+		{
+			Frame.Axes[Axis] = 0.f;
+		}
+	}
+
+	Ar << Frame.PressedActions;
+	Ar << Frame.ReleasedActions;
+	return Ar;
+}
+
+FString UShooterInputReplaySubsystem::GetRecordingPath(const FString& Name, const TCHAR* Extension)
+{
+	return FPaths::ProjectSavedDir() / TEXT("InputRecordings") / Name + Extension;
+}
+
+bool UShooterInputReplaySubsystem::StartRecording(const FString& Name, float FramesPerSecond)
+{
+	if (Mode != EMode::Idle || Name.IsEmpty()) return false;
+
+	RecordingName = Name;
+	Frames.Reset();
+	RandomSeeds.Reset();
+	Character.Reset();
+	bStartStateApplied = false;
+	SessionSeed = FMath::Rand();
+	BeginSession(1.f / FMath::Max(1.f, FramesPerSecond));
+
+	Mode = EMode::Recording;
+	UE_LOG(LogShooter, Display, TEXT("Shooter.Input: recording %s at %.0f fps"), *Name, 1.f / FixedDeltaTime);
+	return true;
+}
+
+void UShooterInputReplaySubsystem::StopRecording()
+{
+	if (Mode != EMode::Recording) return;
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	uint32 Magic = InputRecordingMagic;
+	int32 Version = InputRecordingVersion;
+	FString MapName = GetWorld()->GetMapName();
+	Writer << Magic << Version << MapName << FixedDeltaTime << SessionSeed << StartTransform << StartControlRotation;
+	Writer << Frames << RandomSeeds;
+
+	const FString Path = GetRecordingPath(RecordingName, TEXT(".shinput"));
+	if (FFileHelper::SaveArrayToFile(Data, *Path))
+	{
+		UE_LOG(LogShooter, Display, TEXT("Shooter.Input: wrote %d frames and %d seeds to %s (%d bytes)"), Frames.Num(), RandomSeeds.Num(), *Path, Data.Num());
+	}
+	else
+	{
+		UE_LOG(LogShooter, Error, TEXT("Shooter.Input: couldn't write %s"), *Path);
+	}
+
+	EndSession();
+}
+
+bool UShooterInputReplaySubsystem::StartReplay(const FString& Name, bool bQuitWhenDone)
+{
+	if (Mode != EMode::Idle) return false;
+
+	const FString Path = GetRecordingPath(Name, TEXT(".shinput"));
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Path))
+	{
+		UE_LOG(LogShooter, Error, TEXT("Shooter.Input: couldn't read %s"), *Path);
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	int32 Version = 0;
+	FString MapName;
+	Reader << Magic << Version;
+	if (Magic != InputRecordingMagic || Version != InputRecordingVersion)
+	{
+		UE_LOG(LogShooter, Error, TEXT("Shooter.Input: %s isn't a version %d input recording"), *Path, InputRecordingVersion);
+		return false;
+	}
+	float RecordedDeltaTime = 0.f;
+	Reader << MapName << RecordedDeltaTime << SessionSeed << StartTransform << StartControlRotation;
+	Reader << Frames << RandomSeeds;
+
+	if (MapName != GetWorld()->GetMapName())
+	{
+		UE_LOG(LogShooter, Warning, TEXT("Shooter.Input: %s was recorded on %s, replaying on %s"), *Name, *MapName, *GetWorld()->GetMapName());
+	}
+
+	RecordingName = Name;
+	Character.Reset();
+	bStartStateApplied = false;
+	NextFrame = 0;
+	NextSeed = 0;
+	bQuitWhenReplayDone = bQuitWhenDone;
+	FrameGameThreadMs.Reset(Frames.Num());
+	FrameUsedPhysical.Reset(Frames.Num());
+	BeginSession(RecordedDeltaTime);
+
+	Mode = EMode::Replaying;
+	UE_LOG(LogShooter, Display, TEXT("Shooter.Input: replaying %s, %d frames"), *Name, Frames.Num());
+	return true;
+}
+
+void UShooterInputReplaySubsystem::TickCharacterInput(AShooterCharacter* InCharacter)
+{
+	if (Mode == EMode::Idle) return;
+
+	if (!Character.IsValid())
+	{
+		Character = InCharacter;
+	}
+	if (Character.Get() != InCharacter) return;
+
+	// Both recording and replay start from the same pose
+	if (!bStartStateApplied)
+	{
+		bStartStateApplied = true;
+		AController* Controller = InCharacter->GetController();
+		if (Mode == EMode::Recording)
+		{
+			StartTransform = InCharacter->GetActorTransform();
+			StartControlRotation = Controller ? Controller->GetControlRotation() : FRotator::ZeroRotator;
+		}
+		else
+		{
+			InCharacter->SetActorTransform(StartTransform, false, nullptr, ETeleportType::ResetPhysics);
+			if (Controller)
+			{
+				Controller->SetControlRotation(StartControlRotation);
+			}
+		}
+	}
+
+	if (Mode == EMode::Recording)
+	{
+		InCharacter->CaptureInputFrame(Frames.AddDefaulted_GetRef());
+		return;
+	}
+
+	if (NextFrame >= Frames.Num())
+	{
+		FinishReplay();
+		return;
+	}
+
+	// GGameThreadTime is the previous frame's game thread time
+	FrameGameThreadMs.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+	FrameUsedPhysical.Add(FPlatformMemory::GetStats().UsedPhysical);
+
+	InCharacter->ApplyInputFrame(Frames[NextFrame++]);
+}
+
+int32 UShooterInputReplaySubsystem::NextRandomSeed()
+{
+	if (Mode == EMode::Replaying && NextSeed < RandomSeeds.Num())
+	{
+		return RandomSeeds[NextSeed++];
+	}
+
+	const int32 Seed = FMath::Rand();
+	if (Mode == EMode::Recording)
+	{
+		RandomSeeds.Add(Seed);
+	}
+	return Seed;
+}
+
+void UShooterInputReplaySubsystem::FinishReplay()
+{
+	// One line per frame, so traces from two builds can be diffed or plotted side by side
+	FString Trace = TEXT("Frame,GameThreadMs,UsedPhysicalMB\n");
+	for (int32 Index = 0; Index < FrameGameThreadMs.Num(); Index++)
+	{
+		Trace += FString::Printf(TEXT("%d,%.3f,%.2f\n"), Index, FrameGameThreadMs[Index], FrameUsedPhysical[Index] / (1024.0 * 1024.0));
+	}
+
+	const FString Path = GetRecordingPath(FString::Printf(TEXT("%s-%s-%s"), *RecordingName, LexToString(FApp::GetBuildConfiguration()), *FDateTime::Now().ToString()), TEXT(".csv"));
+	FFileHelper::SaveStringToFile(Trace, *Path);
+
+	double TotalMs = 0.0;
+	for (float Ms : FrameGameThreadMs)
+	{
+		TotalMs += Ms;
+	}
+	UE_LOG(LogShooter, Display, TEXT("Shooter.Input: replayed %s, %d frames, %.3f ms average game thread time, trace in %s"),
+		*RecordingName, FrameGameThreadMs.Num(), FrameGameThreadMs.Num() > 0 ? TotalMs / FrameGameThreadMs.Num() : 0.0, *Path);
+
+	if (NextSeed != RandomSeeds.Num())
+	{
+		UE_LOG(LogShooter, Warning, TEXT("Shooter.Input: replay used %d of %d recorded seeds, the session diverged"), NextSeed, RandomSeeds.Num());
+	}
+
+	EndSession();
+
+	if (bQuitWhenReplayDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UShooterInputReplaySubsystem::BeginSession(float InFixedDeltaTime)
+{
+	FixedDeltaTime = InFixedDeltaTime;
+
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedDeltaTime);
+
+	FMath::RandInit(SessionSeed);
+	FMath::SRandInit(SessionSeed);
+}
+
+void UShooterInputReplaySubsystem::EndSession()
+{
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+
+	Mode = EMode::Idle;
+	Character.Reset();
+}
+
+void UShooterInputReplaySubsystem::Deinitialize()
+{
+	if (Mode == EMode::Recording)
+	{
+		StopRecording();
+	}
+	else if (Mode == EMode::Replaying)
+	{
+		EndSession();
+	}
+
+	Super::Deinitialize();
+}
+
+namespace ShooterInputReplay
+{
+	static void Record(const TArray<FString>& Args, UWorld* World)
+	{
+		UShooterInputReplaySubsystem* Replay = World ? World->GetSubsystem<UShooterInputReplaySubsystem>() : nullptr;
+		if (Replay == nullptr || Args.Num() < 1) return;
+
+		Replay->StartRecording(Args[0], Args.Num() > 1 ? FCString::Atof(*Args[1]) : 30.f);
+	}
+
+	static void Stop(UWorld* World)
+	{
+		UShooterInputReplaySubsystem* Replay = World ? World->GetSubsystem<UShooterInputReplaySubsystem>() : nullptr;
+		if (Replay)
+		{
+			Replay->StopRecording();
+		}
+	}
+
+	static void Play(const TArray<FString>& Args, UWorld* World)
+	{
+		UShooterInputReplaySubsystem* Replay = World ? World->GetSubsystem<UShooterInputReplaySubsystem>() : nullptr;
+		if (Replay == nullptr || Args.Num() < 1) return;
+
+		Replay->StartReplay(Args[0], Args.Contains(TEXT("quit")));
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs RecordCommand(
+		TEXT("Shooter.Input.Record"),
+		TEXT("Records the local player's input at a fixed timestep until Shooter.Input.Stop. Usage: Shooter.Input.Record Name [FPS=30]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Record));
+
+	static FAutoConsoleCommandWithWorld StopCommand(
+		TEXT("Shooter.Input.Stop"),
+		TEXT("Stops recording input and writes Saved/InputRecordings/<Name>.shinput"),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&Stop));
+
+	static FAutoConsoleCommandWithWorldAndArgs ReplayCommand(
+		TEXT("Shooter.Input.Replay"),
+		TEXT("Replays a recording at its fixed timestep and writes a frame time and memory trace. Usage: Shooter.Input.Replay Name [quit]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Play));
+}
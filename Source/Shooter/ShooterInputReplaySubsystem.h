@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterInputReplaySubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** Axes bound in AShooterCharacter::SetupPlayerInputComponent, in recording order */
+enum class EShooterInputAxis : uint8
+{
+	MoveForward,
+	MoveRight,
+	TurnAtRate,
+	LookUpAtRate,
+	Turn,
+	LookUp,
+
+	MAX
+};
+
+/** Actions bound in AShooterCharacter::SetupPlayerInputComponent, as bits in FShooterInputFrame */
+enum class EShooterInputAction : uint8
+{
+	Jump,
+	Fire,
+	Aim,
+	Select,
+	Reload,
+
+	MAX
+};
+
+/** The local player's input for one frame */
+struct FShooterInputFrame
+{
+	float Axes[static_cast<int32>(EShooterInputAxis::MAX)] = {};
+
+	/** Bit per EShooterInputAction pressed or released this frame */
+	uint8 PressedActions = 0;
+	uint8 ReleasedActions = 0;
+
+	FORCEINLINE bool WasPressed(EShooterInputAction Action) const { return (PressedActions & (1 << static_cast<int32>(Action))) != 0; };
+	FORCEINLINE bool WasReleased(EShooterInputAction Action) const { return (ReleasedActions & (1 << static_cast<int32>(Action))) != 0; };
+
+	/** Only axes with input are written, most frames are a few bytes */
+	friend FArchive& operator<<(FArchive& Ar, FShooterInputFrame& Frame);
+};
+
+/**
+ * Records the local player's input stream and the random seeds gameplay draws, at a fixed timestep,
+ * to a binary file in Saved/InputRecordings, and replays it so separate runs and builds play out the
+ * same session. Replays write a per-frame game thread time and memory trace next to the recording.
+ */
+UCLASS()
+class SHOOTER_API UShooterInputReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Starts recording the local player at a fixed timestep of 1 / FramesPerSecond */
+	bool StartRecording(const FString& Name, float FramesPerSecond);
+
+	/** Stops recording and writes the file */
+	void StopRecording();
+
+	/** Loads a recording and starts feeding it to the local player. Quits when finished if bQuitWhenDone */
+	bool StartReplay(const FString& Name, bool bQuitWhenDone);
+
+	/**
+	 * Called by the local player controller each tick, right after it has dispatched live input and before it
+	 * applies the frame's rotation input, so recorded and replayed input reach the character at the same point in the frame
+	 */
+	void TickCharacterInput(AShooterCharacter* Character);
+
+	/** Seed for a gameplay random draw, recorded when recording and handed back in order when replaying */
+	int32 NextRandomSeed();
+
+	FORCEINLINE bool IsRecording() const { return Mode == EMode::Recording; };
+	FORCEINLINE bool IsReplaying() const { return Mode == EMode::Replaying; };
+
+	virtual void Deinitialize() override;
+
+private:
+	enum class EMode : uint8
+	{
+		Idle,
+		Recording,
+		Replaying
+	};
+
+	/** Where a recording called Name lives */
+	static FString GetRecordingPath(const FString& Name, const TCHAR* Extension);
+
+	/** Locks the engine to the recording's timestep and seeds the global random streams */
+	void BeginSession(float FixedDeltaTime);
+	void EndSession();
+
+	void FinishReplay();
+
+	EMode Mode = EMode::Idle;
+	FString RecordingName;
+
+	/** Character being recorded or replayed, the first local player to tick */
+	TWeakObjectPtr<AShooterCharacter> Character;
+	bool bStartStateApplied = false;
+
+	/** Recording contents */
+	float FixedDeltaTime = 0.f;
+	int32 SessionSeed = 0;
+	FTransform StartTransform;
+	FRotator StartControlRotation;
+	TArray<FShooterInputFrame> Frames;
+	TArray<int32> RandomSeeds;
+
+	/** Replay progress */
+	int32 NextFrame = 0;
+	int32 NextSeed = 0;
+	bool bQuitWhenReplayDone = false;
+
+	/** Per frame game thread time in ms and physical memory in use, written out when the replay ends */
+	TArray<float> FrameGameThreadMs;
+	TArray<uint64> FrameUsedPhysical;
+
+	/** Engine timestep settings to restore when the session ends */
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+};
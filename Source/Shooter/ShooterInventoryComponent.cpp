@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterInventoryComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Shooter.h"
+
+bool FAmmoInventory::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Each count only takes as many bits as MaxCarriedAmmo needs
+	for (int32& Count : Counts)
+	{
+		uint32 Value = static_cast<uint32>(FMath::Clamp(Count, 0, MaxCarriedAmmo));
+		Ar.SerializeInt(Value, MaxCarriedAmmo + 1);
+		Count = static_cast<int32>(Value);
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+bool FAmmoInventory::operator==(const FAmmoInventory& Other) const
+{
+	return FMemory::Memcmp(Counts, Other.Counts, sizeof(Counts)) == 0;
+}
+
+UShooterInventoryComponent::UShooterInventoryComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void UShooterInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(UShooterInventoryComponent, Ammo, COND_OwnerOnly);
+}
+
+int32 UShooterInventoryComponent::GetAmmo(EAmmoType AmmoType) const
+{
+	if (AmmoType >= EAmmoType::EAT_MAX) return 0;
+
+	return Ammo.Counts[static_cast<int32>(AmmoType)];
+}
+
+void UShooterInventoryComponent::SetAmmo(EAmmoType AmmoType, int32 Amount)
+{
+	if (AmmoType >= EAmmoType::EAT_MAX) return;
+
+	if (Amount > FAmmoInventory::MaxCarriedAmmo)
+	{
+		UE_LOG(LogShooter, Warning, TEXT("%s: %d ammo of type %d is over the carry limit, %d dropped"),
+			*GetNameSafe(GetOwner()), Amount, static_cast<int32>(AmmoType), Amount - FAmmoInventory::MaxCarriedAmmo);
+	}
+
+	int32& Count = Ammo.Counts[static_cast<int32>(AmmoType)];
+	const int32 NewCount = FMath::Clamp(Amount, 0, FAmmoInventory::MaxCarriedAmmo);
+	if (Count == NewCount) return;
+
+	Count = NewCount;
+	OnAmmoChanged.Broadcast(AmmoType, Count);
+}
+
+void UShooterInventoryComponent::OnRep_Ammo(const FAmmoInventory& OldAmmo)
+{
+	for (int32 Type = 0; Type < static_cast<int32>(EAmmoType::EAT_MAX); Type++)
+	{
+		if (Ammo.Counts[Type] != OldAmmo.Counts[Type])
+		{
+			OnAmmoChanged.Broadcast(static_cast<EAmmoType>(Type), Ammo.Counts[Type]);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AmmoType.h"
+#include "ShooterInventoryComponent.generated.h"
+
+/** Carried ammo for every EAmmoType, stored in a fixed-size array and bit-packed for replication */
+USTRUCT()
+struct FAmmoInventory
+{
+	GENERATED_BODY()
+
+	/** Most ammo of a single type that can be carried, bounds the bits used per count on the wire */
+	static constexpr int32 MaxCarriedAmmo = 1023;
+
+	/** Ammo carried, indexed by EAmmoType */
+	int32 Counts[static_cast<int32>(EAmmoType::EAT_MAX)] = {};
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FAmmoInventory& Other) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FAmmoInventory> : public TStructOpsTypeTraitsBase2<FAmmoInventory>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnInventoryAmmoChanged, EAmmoType, int32 /* Amount */);
+
+/** Holds the ammo a character is carrying with constant-time access by EAmmoType */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SHOOTER_API UShooterInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterInventoryComponent();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Ammo of this type currently carried */
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	int32 GetAmmo(EAmmoType AmmoType) const;
+
+	/** Sets the ammo carried of this type, clamped to FAmmoInventory::MaxCarriedAmmo. Logs a warning for any ammo lost to the cap */
+	void SetAmmo(EAmmoType AmmoType, int32 Amount);
+
+	/** Broadcast when the ammo carried of a type changes, on the server and on the owning client as it replicates */
+	FOnInventoryAmmoChanged OnAmmoChanged;
+
+private:
+	/** Ammo carried, replicated to the owning client only */
+	UPROPERTY(ReplicatedUsing = OnRep_Ammo)
+	FAmmoInventory Ammo;
+
+	UFUNCTION()
+	void OnRep_Ammo(const FAmmoInventory& OldAmmo);
+};
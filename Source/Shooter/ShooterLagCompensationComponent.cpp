@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterLagCompensationComponent.h"
+#include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "ShooterLagCompensationSubsystem.h"
+
+UShooterLagCompensationComponent::UShooterLagCompensationComponent() :
+	Mesh(nullptr),
+	NumHitboxes(0),
+	NewestSample(MaxSamples - 1),
+	NumSamples(0)
+{
+	// Recording is driven by UShooterLagCompensationSubsystem
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// Mannequin skeleton
+	Hitboxes = {
+		{ FName("head"), NAME_None, 15.f },
+		{ FName("pelvis"), FName("spine_03"), 22.f },
+		{ FName("upperarm_l"), FName("lowerarm_l"), 8.f },
+		{ FName("lowerarm_l"), FName("hand_l"), 6.f },
+		{ FName("upperarm_r"), FName("lowerarm_r"), 8.f },
+		{ FName("lowerarm_r"), FName("hand_r"), 6.f },
+		{ FName("thigh_l"), FName("calf_l"), 11.f },
+		{ FName("calf_l"), FName("foot_l"), 9.f },
+		{ FName("thigh_r"), FName("calf_r"), 11.f },
+		{ FName("calf_r"), FName("foot_r"), 9.f }
+	};
+}
+
+void UShooterLagCompensationComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	Mesh = Character ? Character->GetMesh() : nullptr;
+	if (Mesh == nullptr) return;
+
+	NumHitboxes = 0;
+	for (const FShooterHitboxDefinition& Hitbox : Hitboxes)
+	{
+		if (NumHitboxes == MaxHitboxes) break;
+
+		const int32 StartBoneIndex = Mesh->GetBoneIndex(Hitbox.StartBone);
+		if (StartBoneIndex == INDEX_NONE) continue;
+
+		StartBoneIndices[NumHitboxes] = StartBoneIndex;
+		EndBoneIndices[NumHitboxes] = Hitbox.EndBone.IsNone() ? INDEX_NONE : Mesh->GetBoneIndex(Hitbox.EndBone);
+		Radii[NumHitboxes] = Hitbox.Radius;
+		BoneNames[NumHitboxes] = Hitbox.StartBone;
+		NumHitboxes++;
+	}
+
+	UShooterLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UShooterLagCompensationSubsystem>();
+	if (LagCompensation && NumHitboxes > 0)
+	{
+		LagCompensation->Register(this);
+	}
+}
+
+void UShooterLagCompensationComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UShooterLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UShooterLagCompensationSubsystem>();
+	if (LagCompensation)
+	{
+		LagCompensation->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UShooterLagCompensationComponent::RecordSample(float Time)
+{
+	if (Mesh == nullptr) return;
+
+	NewestSample = (NewestSample + 1) % MaxSamples;
+	NumSamples = FMath::Min(NumSamples + 1, MaxSamples);
+
+	FPoseSample& Sample = Samples[NewestSample];
+	Sample.Time = Time;
+	Sample.BoundsCenter = Mesh->Bounds.Origin;
+	Sample.BoundsRadius = Mesh->Bounds.SphereRadius;
+
+	for (int32 i = 0; i < NumHitboxes; i++)
+	{
+		Sample.Starts[i] = Mesh->GetBoneTransform(StartBoneIndices[i]).GetLocation();
+		Sample.Ends[i] = EndBoneIndices[i] == INDEX_NONE ? Sample.Starts[i] : Mesh->GetBoneTransform(EndBoneIndices[i]).GetLocation();
+	}
+}
+
+float UShooterLagCompensationComponent::GetHistoryDuration() const
+{
+	if (NumSamples < 2) return 0.f;
+
+	return GetSample(0).Time - GetSample(NumSamples - 1).Time;
+}
+
+bool UShooterLagCompensationComponent::TraceRewound(float Time, const FVector& Start, const FVector& End, FShooterRewindHit& OutHit) const
+{
+	if (NumSamples == 0) return false;
+
+	// Find the samples either side of Time, clamping to the ends of the history
+	int32 Newer = 0;
+	while (Newer + 1 < NumSamples && GetSample(Newer).Time > Time)
+	{
+		Newer++;
+	}
+	const int32 Older = FMath::Min(Newer + 1, NumSamples - 1);
+	const FPoseSample& NewerSample = GetSample(Newer);
+	const FPoseSample& OlderSample = GetSample(Older);
+
+	const float SampleSpan = NewerSample.Time - OlderSample.Time;
+	const float Alpha = SampleSpan > KINDA_SMALL_NUMBER ? FMath::Clamp((Time - OlderSample.Time) / SampleSpan, 0.f, 1.f) : 1.f;
+
+	const FVector Ray = End - Start;
+	const float RayLength = Ray.Size();
+	if (RayLength < KINDA_SMALL_NUMBER) return false;
+	const FVector RayDirection = Ray / RayLength;
+
+	// Reject rays that miss the whole mesh
+	const FVector BoundsCenter = FMath::Lerp(OlderSample.BoundsCenter, NewerSample.BoundsCenter, Alpha);
+	const float BoundsRadius = FMath::Max(OlderSample.BoundsRadius, NewerSample.BoundsRadius);
+	if (FMath::PointDistToSegmentSquared(BoundsCenter, Start, End) > FMath::Square(BoundsRadius))
+	{
+		return false;
+	}
+
+	bool bHit = false;
+	for (int32 i = 0; i < NumHitboxes; i++)
+	{
+		const FVector HitboxStart = FMath::Lerp(OlderSample.Starts[i], NewerSample.Starts[i], Alpha);
+		const FVector HitboxEnd = FMath::Lerp(OlderSample.Ends[i], NewerSample.Ends[i], Alpha);
+
+		FVector OnRay;
+		FVector OnHitbox;
+		FMath::SegmentDistToSegmentSafe(Start, End, HitboxStart, HitboxEnd, OnRay, OnHitbox);
+
+		const float DistSquared = FVector::DistSquared(OnRay, OnHitbox);
+		const float RadiusSquared = FMath::Square(Radii[i]);
+		if (DistSquared > RadiusSquared) continue;
+
+		// Step back from the closest point to the surface. Exact for spheres, close enough for the capsules
+		const float Distance = FMath::Max(0.f, FVector::Dist(Start, OnRay) - FMath::Sqrt(RadiusSquared - DistSquared));
+		if (Distance < OutHit.Distance)
+		{
+			OutHit.Actor = GetOwner();
+			OutHit.BoneName = BoneNames[i];
+			OutHit.Distance = Distance;
+			OutHit.Location = Start + RayDirection * Distance;
+			bHit = true;
+		}
+	}
+	return bHit;
+}
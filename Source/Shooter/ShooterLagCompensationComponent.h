@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ShooterLagCompensationComponent.generated.h"
+
+/** A capsule between two bones (or a sphere on one bone) used for lag-compensated hit tests */
+USTRUCT(BlueprintType)
+struct FShooterHitboxDefinition
+{
+	GENERATED_BODY()
+
+	FShooterHitboxDefinition() {}
+
+	FShooterHitboxDefinition(FName InStartBone, FName InEndBone, float InRadius) :
+		StartBone(InStartBone),
+		EndBone(InEndBone),
+		Radius(InRadius)
+	{}
+
+	/** Bone the hitbox starts at */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hitbox")
+	FName StartBone;
+
+	/** Bone the hitbox ends at. None for a sphere around StartBone */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hitbox")
+	FName EndBone;
+
+	/** Radius of the capsule or sphere */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hitbox")
+	float Radius = 10.f;
+};
+
+/** Closest rewound hitbox hit along a ray */
+struct FShooterRewindHit
+{
+	AActor* Actor = nullptr;
+	FName BoneName;
+	FVector Location = FVector::ZeroVector;
+
+	/** Distance from the ray start to the hit */
+	float Distance = BIG_NUMBER;
+};
+
+/**
+ * Records the character's hitboxes into a fixed-size ring buffer every server tick, so shots can be
+ * tested against where the character was when the shooter fired. Nothing is allocated after BeginPlay.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SHOOTER_API UShooterLagCompensationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Most hitboxes a character can have */
+	static constexpr int32 MaxHitboxes = 16;
+
+	/** Poses kept in the history. At a 30Hz server tick this covers about a second */
+	static constexpr int32 MaxSamples = 32;
+
+	UShooterLagCompensationComponent();
+
+	/** Appends the current hitbox pose to the history, overwriting the oldest sample */
+	void RecordSample(float Time);
+
+	/**
+	 * Tests a ray against the hitboxes as they were at Time, interpolated between the two nearest samples.
+	 * Only reads the history, so it is safe to call from worker threads while nothing is recording.
+	 * @return true if a hitbox closer than OutHit.Distance was hit, in which case OutHit is updated
+	 */
+	bool TraceRewound(float Time, const FVector& Start, const FVector& End, FShooterRewindHit& OutHit) const;
+
+	/** Bytes of history kept by each component */
+	static constexpr SIZE_T GetHistorySize() { return sizeof(FPoseSample) * MaxSamples; }
+
+	FORCEINLINE int32 GetNumSamples() const { return NumSamples; };
+	FORCEINLINE int32 GetNumHitboxes() const { return NumHitboxes; };
+
+	/** Time span covered by the history */
+	float GetHistoryDuration() const;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** Hitbox endpoints in world space at one point in time */
+	struct FPoseSample
+	{
+		float Time;
+
+		/** Sphere around the whole mesh, for rejecting rays early */
+		FVector BoundsCenter;
+		float BoundsRadius;
+
+		FVector Starts[MaxHitboxes];
+		FVector Ends[MaxHitboxes];
+	};
+
+	/** Sample Index steps back from the newest */
+	FORCEINLINE const FPoseSample& GetSample(int32 Index) const { return Samples[(NewestSample - Index + MaxSamples) % MaxSamples]; };
+
+	/** Hitboxes to record, capped at MaxHitboxes */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation", meta = (AllowPrivateAccess = "true"))
+	TArray<FShooterHitboxDefinition> Hitboxes;
+
+	/** Mesh the hitboxes are read from */
+	UPROPERTY()
+	class USkeletalMeshComponent* Mesh;
+
+	/** Hitbox bone indices resolved at BeginPlay. End is INDEX_NONE for spheres */
+	int32 StartBoneIndices[MaxHitboxes];
+	int32 EndBoneIndices[MaxHitboxes];
+	float Radii[MaxHitboxes];
+	FName BoneNames[MaxHitboxes];
+	int32 NumHitboxes;
+
+	/** Ring buffer of poses */
+	FPoseSample Samples[MaxSamples];
+	int32 NewestSample;
+	int32 NumSamples;
+};
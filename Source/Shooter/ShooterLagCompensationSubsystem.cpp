@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterLagCompensationSubsystem.h"
+#include "Engine/World.h"
+#include "ShooterLagCompensationComponent.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Record"), STAT_LagCompRecord, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Rewind"), STAT_LagCompRewind, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lag Compensation Rewinds"), STAT_LagCompRewinds, STATGROUP_Shooter);
+DECLARE_MEMORY_STAT(TEXT("Lag Compensation History"), STAT_LagCompHistoryMemory, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<float> CVarLagCompMaxRewindTime(
+	TEXT("Shooter.LagComp.MaxRewindTime"),
+	0.5f,
+	TEXT("Furthest back in seconds a shot can be rewound. Older shots are tested against the oldest allowed pose."),
+	ECVF_Default);
+
+void UShooterLagCompensationSubsystem::Register(UShooterLagCompensationComponent* Component)
+{
+	Components.AddUnique(Component);
+	INC_MEMORY_STAT_BY(STAT_LagCompHistoryMemory, UShooterLagCompensationComponent::GetHistorySize());
+}
+
+void UShooterLagCompensationSubsystem::Unregister(UShooterLagCompensationComponent* Component)
+{
+	if (Components.RemoveSwap(Component) > 0)
+	{
+		DEC_MEMORY_STAT_BY(STAT_LagCompHistoryMemory, UShooterLagCompensationComponent::GetHistorySize());
+	}
+}
+
+float UShooterLagCompensationSubsystem::GetMaxRewindTime()
+{
+	return CVarLagCompMaxRewindTime.GetValueOnAnyThread();
+}
+
+bool UShooterLagCompensationSubsystem::TraceRewound(float Time, const FVector& Start, const FVector& End, const AActor* IgnoreActor, FShooterRewindHit& OutHit) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_LagCompRewind);
+	INC_DWORD_STAT(STAT_LagCompRewinds);
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float RewindTime = FMath::Clamp(Time, Now - GetMaxRewindTime(), Now);
+
+	bool bHit = false;
+	for (const UShooterLagCompensationComponent* Component : Components)
+	{
+		if (Component->GetOwner() == IgnoreActor) continue;
+
+		bHit |= Component->TraceRewound(RewindTime, Start, End, OutHit);
+	}
+
+	NumRewinds.Increment();
+	RewindCycles.Add(FPlatformTime::Cycles() - StartCycles);
+	return bHit;
+}
+
+void UShooterLagCompensationSubsystem::GetCompensatedActors(TArray<AActor*>& OutActors) const
+{
+	for (const UShooterLagCompensationComponent* Component : Components)
+	{
+		OutActors.Add(Component->GetOwner());
+	}
+}
+
+void UShooterLagCompensationSubsystem::LogReport() const
+{
+	const SIZE_T HistorySize = UShooterLagCompensationComponent::GetHistorySize();
+	UE_LOG(LogShooter, Display, TEXT("Lag compensation: %d characters, %d bytes of history each (%d samples x %d hitboxes max), %d bytes total"),
+		Components.Num(), static_cast<int32>(HistorySize), UShooterLagCompensationComponent::MaxSamples,
+		UShooterLagCompensationComponent::MaxHitboxes, static_cast<int32>(HistorySize * Components.Num()));
+
+	for (const UShooterLagCompensationComponent* Component : Components)
+	{
+		UE_LOG(LogShooter, Display, TEXT("  %s: %d hitboxes, %d samples covering %.3fs"),
+			*Component->GetOwner()->GetName(), Component->GetNumHitboxes(), Component->GetNumSamples(), Component->GetHistoryDuration());
+	}
+
+	const int64 Rewinds = NumRewinds.GetValue();
+	UE_LOG(LogShooter, Display, TEXT("  %lld rewinds, %.2f us average per shot"),
+		Rewinds, Rewinds > 0 ? FPlatformTime::ToMilliseconds64(RewindCycles.GetValue()) * 1000.0 / Rewinds : 0.0);
+}
+
+void UShooterLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LagCompRecord);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (UShooterLagCompensationComponent* Component : Components)
+	{
+		Component->RecordSample(Now);
+	}
+}
+
+bool UShooterLagCompensationSubsystem::IsRecording() const
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+	return NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+}
+
+bool UShooterLagCompensationSubsystem::IsTickable() const
+{
+	return Components.Num() > 0 && IsRecording();
+}
+
+ETickableTickType UShooterLagCompensationSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UShooterLagCompensationSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UShooterLagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterLagCompensationSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "ShooterLagCompensationSubsystem.generated.h"
+
+class UShooterLagCompensationComponent;
+struct FShooterRewindHit;
+
+/**
+ * Records the hitbox history of every lag-compensated character once per server tick,
+ * and tests shots against the characters as they were when the shot was fired.
+ */
+UCLASS()
+class SHOOTER_API UShooterLagCompensationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	void Register(UShooterLagCompensationComponent* Component);
+	void Unregister(UShooterLagCompensationComponent* Component);
+
+	/**
+	 * Tests a ray against every character's hitboxes rewound to Time, clamped to Shooter.LagComp.MaxRewindTime.
+	 * Safe to call from worker threads while the subsystem isn't recording.
+	 * @return true if a hitbox was hit, OutHit holds the closest
+	 */
+	bool TraceRewound(float Time, const FVector& Start, const FVector& End, const AActor* IgnoreActor, FShooterRewindHit& OutHit) const;
+
+	/** Furthest back in seconds a shot can be rewound (Shooter.LagComp.MaxRewindTime) */
+	static float GetMaxRewindTime();
+
+	/** Characters whose hitboxes are recorded, to be ignored by world traces that use TraceRewound */
+	void GetCompensatedActors(TArray<AActor*>& OutActors) const;
+
+	/** Logs history memory, coverage and rewind cost */
+	void LogReport() const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Only servers need a history to validate shots against */
+	bool IsRecording() const;
+
+	UPROPERTY()
+	TArray<UShooterLagCompensationComponent*> Components;
+
+	/** Rewinds done and the cycles they took, updated from worker threads */
+	mutable FThreadSafeCounter64 NumRewinds;
+	mutable FThreadSafeCounter64 RewindCycles;
+};
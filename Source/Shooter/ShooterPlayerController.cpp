@@ -3,8 +3,18 @@
 
 #include "ShooterPlayerController.h"
 #include "Blueprint/UserWidget.h"
+#include "Components/WidgetComponent.h"
+#include "PickupWidget.h"
+#include "ShooterHUDOverlay.h"
+#include "ShooterCharacter.h"
+#include "ShooterInputReplaySubsystem.h"
+#include "Item.h"
+#include "Shooter.h"
 
-AShooterPlayerController::AShooterPlayerController()
+AShooterPlayerController::AShooterPlayerController() :
+	PickupWidgetClass(FSoftClassPath(TEXT("/Game/_Game/HUD/PickupWidget_BP.PickupWidget_BP_C"))),
+	PickupWidgetOffset(0.f, 0.f, 50.f),
+	ItemReferenceProperty(nullptr)
 {
 
 }
@@ -13,14 +23,99 @@ void AShooterPlayerController::BeginPlay()
 {
 	Super::BeginPlay();
 
+#if !UE_SERVER
+	// Widgets only exist for the player on this machine
+	if (!IsLocalController()) return;
+
 	// Check HUD Overlay class TSubclassOf variable has been set in blueprint
-	if (HUDOverlayClass)
+	if (UClass* OverlayClass = HUDOverlayClass.LoadSynchronous())
 	{
-		HUDOverlay = CreateWidget<UUserWidget>(this, HUDOverlayClass);
+		HUDOverlay = CreateWidget<UUserWidget>(this, OverlayClass);
 		if (HUDOverlay)
 		{
 			HUDOverlay->AddToViewport();
 			HUDOverlay->SetVisibility(ESlateVisibility::Visible);
+
+			if (UShooterHUDOverlay* ShooterHUDOverlay = Cast<UShooterHUDOverlay>(HUDOverlay))
+			{
+				ShooterHUDOverlay->SetCharacter(Cast<AShooterCharacter>(GetPawn()));
+			}
 		}
 	}
-}
\ No newline at end of file
+
+	// Create the single pickup widget this player will use for every item
+	if (UClass* PickupClass = PickupWidgetClass.LoadSynchronous())
+	{
+		PickupWidgetComponent = NewObject<UWidgetComponent>(this, TEXT("PickupWidget"));
+		PickupWidgetComponent->SetWidgetSpace(EWidgetSpace::Screen);
+		PickupWidgetComponent->SetDrawAtDesiredSize(true);
+		PickupWidgetComponent->SetWidgetClass(PickupClass);
+		PickupWidgetComponent->SetVisibility(false);
+		PickupWidgetComponent->RegisterComponent();
+
+		// A widget blueprint that predates UPickupWidget binds to its own item variable, set that instead
+		if (!PickupClass->IsChildOf(UPickupWidget::StaticClass()))
+		{
+			ItemReferenceProperty = FindFProperty<FObjectPropertyBase>(PickupClass, TEXT("ItemReference"));
+			if (ItemReferenceProperty && !AItem::StaticClass()->IsChildOf(ItemReferenceProperty->PropertyClass))
+			{
+				ItemReferenceProperty = nullptr;
+			}
+			UE_LOG(LogShooter, Warning, TEXT("%s isn't parented to UPickupWidget, %s"), *PickupClass->GetName(),
+				ItemReferenceProperty ? TEXT("setting its ItemReference variable instead") : TEXT("and has no ItemReference variable to set"));
+		}
+	}
+#endif
+}
+
+void AShooterPlayerController::SetPawn(APawn* InPawn)
+{
+	Super::SetPawn(InPawn);
+
+	if (UShooterHUDOverlay* ShooterHUDOverlay = Cast<UShooterHUDOverlay>(HUDOverlay))
+	{
+		ShooterHUDOverlay->SetCharacter(Cast<AShooterCharacter>(InPawn));
+	}
+}
+
+void AShooterPlayerController::PostProcessInput(const float DeltaTime, const bool bGamePaused)
+{
+	Super::PostProcessInput(DeltaTime, bGamePaused);
+
+	// PlayerTick applies the rotation input after this, so replayed Turn and LookUp land on the same frame live input would
+	AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>(GetPawn());
+	UShooterInputReplaySubsystem* InputReplay = GetWorld()->GetSubsystem<UShooterInputReplaySubsystem>();
+	if (ShooterCharacter && InputReplay)
+	{
+		InputReplay->TickCharacterInput(ShooterCharacter);
+	}
+}
+
+void AShooterPlayerController::ShowPickupWidget(AItem* Item)
+{
+	if (PickupWidgetComponent == nullptr || Item == nullptr) return;
+
+	if (PickupWidgetComponent->GetAttachParent() != Item->GetRootComponent())
+	{
+		PickupWidgetComponent->AttachToComponent(Item->GetRootComponent(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		PickupWidgetComponent->SetRelativeLocation(PickupWidgetOffset);
+	}
+
+	UUserWidget* Widget = PickupWidgetComponent->GetUserWidgetObject();
+	if (UPickupWidget* PickupWidget = Cast<UPickupWidget>(Widget))
+	{
+		PickupWidget->SetItem(Item);
+	}
+	else if (Widget && ItemReferenceProperty)
+	{
+		ItemReferenceProperty->SetObjectPropertyValue_InContainer(Widget, Item);
+	}
+	PickupWidgetComponent->SetVisibility(true);
+}
+
+void AShooterPlayerController::HidePickupWidget()
+{
+	if (PickupWidgetComponent == nullptr) return;
+
+	PickupWidgetComponent->SetVisibility(false);
+}
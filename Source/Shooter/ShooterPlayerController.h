@@ -17,15 +17,45 @@ class SHOOTER_API AShooterPlayerController : public APlayerController
 public:
 	AShooterPlayerController();
 
+	/** Points the shared pickup widget at Item and shows it */
+	void ShowPickupWidget(class AItem* Item);
+
+	/** Hides the shared pickup widget */
+	void HidePickupWidget();
+
+	/** Points the HUD at the newly possessed character, on the server and on clients */
+	virtual void SetPawn(APawn* InPawn) override;
+
 protected:
 	virtual void BeginPlay() override;
 
+	/** Records or replays the controlled character's input once live input has been processed, before the frame's rotation input is applied */
+	virtual void PostProcessInput(const float DeltaTime, const bool bGamePaused) override;
+
 private:
-	/** Reference to the overall screen HUD Overlay Blueprint class */
+	/** Reference to the overall screen HUD Overlay Blueprint class. Soft so servers never load it. Parent it to UShooterHUDOverlay for event-driven updates */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Widgets", meta = (AllowPrivateAccess = "true"))
-	TSubclassOf<class UUserWidget> HUDOverlayClass;
+	TSoftClassPtr<class UUserWidget> HUDOverlayClass;
 
 	/** Variable to hold the HUD overlay widget after instantiating it */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Widgets", meta = (AllowPrivateAccess = "true"))
 	UUserWidget* HUDOverlay;
+
+	/**
+	 * Pickup widget class shown over the item the player is looking at. Soft so servers never load it.
+	 * Parent it to UPickupWidget, otherwise the item is written to its ItemReference variable instead
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	TSoftClassPtr<class UUserWidget> PickupWidgetClass;
+
+	/** Offset of the pickup widget from the root of the item it is showing */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	FVector PickupWidgetOffset;
+
+	/** The one pickup widget for this player, re-targeted to whichever item is being looked at */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Widgets", meta = (AllowPrivateAccess = "true"))
+	class UWidgetComponent* PickupWidgetComponent;
+
+	/** ItemReference variable of a pickup widget class not yet parented to UPickupWidget */
+	FObjectPropertyBase* ItemReferenceProperty;
 };
\ No newline at end of file
@@ -0,0 +1,306 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterProjectileSubsystem.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "ShooterCharacter.h"
+#include "ShooterHitscanSubsystem.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Projectiles"), STAT_LiveProjectiles, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Impacts"), STAT_ProjectileImpacts, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Projectile Tick"), STAT_ProjectileTick, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Projectile Integrate"), STAT_ProjectileIntegrate, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Projectile Sweep"), STAT_ProjectileSweep, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarMaxProjectiles(
+	TEXT("Shooter.Projectiles.Max"),
+	16384,
+	TEXT("Most ballistic rounds alive at once. Rounds fired past this are resolved as hitscan."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarProjectileChunkSize(
+	TEXT("Shooter.Projectiles.ChunkSize"),
+	1024,
+	TEXT("Rounds integrated per worker task. Fewer rounds than this are integrated on the game thread."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarProjectileSweepParallelThreshold(
+	TEXT("Shooter.Projectiles.SweepParallelThreshold"),
+	16,
+	TEXT("Minimum number of rounds in flight before their sweeps are spread across worker threads."),
+	ECVF_Default);
+
+void FShooterProjectileData::Add(const FVector& Location, const FVector& Velocity, float InDrag, float InLifetime, AShooterCharacter* InInstigator, const UWeaponDefinition* InWeaponDefinition, float InFirstStepTime)
+{
+	PositionX.Add(Location.X);
+	PositionY.Add(Location.Y);
+	PositionZ.Add(Location.Z);
+	PreviousX.Add(Location.X);
+	PreviousY.Add(Location.Y);
+	PreviousZ.Add(Location.Z);
+	VelocityX.Add(Velocity.X);
+	VelocityY.Add(Velocity.Y);
+	VelocityZ.Add(Velocity.Z);
+	Drag.Add(InDrag);
+	Lifetime.Add(InLifetime);
+	FirstStepTime.Add(InFirstStepTime);
+	Instigator.Add(InInstigator);
+	WeaponDefinition.Add(InWeaponDefinition);
+	LaunchLocation.Add(Location);
+}
+
+void FShooterProjectileData::RemoveAtSwap(int32 Index)
+{
+	PositionX.RemoveAtSwap(Index, 1, false);
+	PositionY.RemoveAtSwap(Index, 1, false);
+	PositionZ.RemoveAtSwap(Index, 1, false);
+	PreviousX.RemoveAtSwap(Index, 1, false);
+	PreviousY.RemoveAtSwap(Index, 1, false);
+	PreviousZ.RemoveAtSwap(Index, 1, false);
+	VelocityX.RemoveAtSwap(Index, 1, false);
+	VelocityY.RemoveAtSwap(Index, 1, false);
+	VelocityZ.RemoveAtSwap(Index, 1, false);
+	Drag.RemoveAtSwap(Index, 1, false);
+	Lifetime.RemoveAtSwap(Index, 1, false);
+	FirstStepTime.RemoveAtSwap(Index, 1, false);
+	Instigator.RemoveAtSwap(Index, 1, false);
+	WeaponDefinition.RemoveAtSwap(Index, 1, false);
+	LaunchLocation.RemoveAtSwap(Index, 1, false);
+}
+
+void FShooterProjectileData::Reserve(int32 Number)
+{
+	PositionX.Reserve(Number);
+	PositionY.Reserve(Number);
+	PositionZ.Reserve(Number);
+	PreviousX.Reserve(Number);
+	PreviousY.Reserve(Number);
+	PreviousZ.Reserve(Number);
+	VelocityX.Reserve(Number);
+	VelocityY.Reserve(Number);
+	VelocityZ.Reserve(Number);
+	Drag.Reserve(Number);
+	Lifetime.Reserve(Number);
+	FirstStepTime.Reserve(Number);
+	Instigator.Reserve(Number);
+	WeaponDefinition.Reserve(Number);
+	LaunchLocation.Reserve(Number);
+}
+
+void FShooterProjectileData::Empty()
+{
+	PositionX.Empty();
+	PositionY.Empty();
+	PositionZ.Empty();
+	PreviousX.Empty();
+	PreviousY.Empty();
+	PreviousZ.Empty();
+	VelocityX.Empty();
+	VelocityY.Empty();
+	VelocityZ.Empty();
+	Drag.Empty();
+	Lifetime.Empty();
+	FirstStepTime.Empty();
+	Instigator.Empty();
+	WeaponDefinition.Empty();
+	LaunchLocation.Empty();
+}
+
+bool UShooterProjectileSubsystem::LaunchProjectile(const FVector& Location, const FVector& Velocity, float Drag, float Lifetime,
+	AShooterCharacter* Instigator, const UWeaponDefinition* WeaponDefinition, float FlightTime)
+{
+	const int32 MaxProjectiles = CVarMaxProjectiles.GetValueOnGameThread();
+	if (Projectiles.Num() >= MaxProjectiles) return false;
+
+	if (Projectiles.Num() == 0)
+	{
+		// Grow once to the budget rather than a few times while the first bursts come in
+		Projectiles.Reserve(FMath::Min(MaxProjectiles, 1024));
+	}
+	Projectiles.Add(Location, Velocity, Drag, Lifetime, Instigator, WeaponDefinition, FMath::Max(FlightTime, 0.f));
+	return true;
+}
+
+void UShooterProjectileSubsystem::ClearProjectiles()
+{
+	Projectiles.Empty();
+	SweepHits.Empty();
+	IgnoredActors.Empty();
+	LastTickProjectiles = 0;
+	LastTickSeconds = 0.0;
+	SET_DWORD_STAT(STAT_LiveProjectiles, 0);
+}
+
+void UShooterProjectileSubsystem::Deinitialize()
+{
+	ClearProjectiles();
+	Super::Deinitialize();
+}
+
+void UShooterProjectileSubsystem::Integrate(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileIntegrate);
+	CSV_SCOPED_TIMING_STAT(Shooter, ProjectileIntegrate);
+
+	const int32 NumProjectiles = Projectiles.Num();
+	const int32 ChunkSize = FMath::Max(1, CVarProjectileChunkSize.GetValueOnGameThread());
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumProjectiles, ChunkSize);
+	const float GravityZ = GetWorld()->GetGravityZ();
+
+	float* RESTRICT PositionX = Projectiles.PositionX.GetData();
+	float* RESTRICT PositionY = Projectiles.PositionY.GetData();
+	float* RESTRICT PositionZ = Projectiles.PositionZ.GetData();
+	float* RESTRICT PreviousX = Projectiles.PreviousX.GetData();
+	float* RESTRICT PreviousY = Projectiles.PreviousY.GetData();
+	float* RESTRICT PreviousZ = Projectiles.PreviousZ.GetData();
+	float* RESTRICT VelocityX = Projectiles.VelocityX.GetData();
+	float* RESTRICT VelocityY = Projectiles.VelocityY.GetData();
+	float* RESTRICT VelocityZ = Projectiles.VelocityZ.GetData();
+	const float* RESTRICT Drag = Projectiles.Drag.GetData();
+	float* RESTRICT Lifetime = Projectiles.Lifetime.GetData();
+	float* RESTRICT FirstStepTime = Projectiles.FirstStepTime.GetData();
+
+	ParallelFor(NumChunks, [=](int32 Chunk)
+	{
+		const int32 Begin = Chunk * ChunkSize;
+		const int32 End = FMath::Min(Begin + ChunkSize, NumProjectiles);
+
+		// Semi-implicit Euler. Straight-line float math with selects rather than branches, so the compiler can vectorize it
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			// A round launched this frame only steps as far as it has flown since it was fired
+			const float StepTime = FirstStepTime[Index] >= 0.f ? FirstStepTime[Index] : DeltaTime;
+			FirstStepTime[Index] = -1.f;
+
+			const float VX = VelocityX[Index];
+			const float VY = VelocityY[Index];
+			const float VZ = VelocityZ[Index];
+			const float DragScale = FMath::Min(Drag[Index] * FMath::Sqrt(VX * VX + VY * VY + VZ * VZ) * StepTime, 1.f);
+
+			const float NewVX = VX - VX * DragScale;
+			const float NewVY = VY - VY * DragScale;
+			const float NewVZ = VZ - VZ * DragScale + GravityZ * StepTime;
+			VelocityX[Index] = NewVX;
+			VelocityY[Index] = NewVY;
+			VelocityZ[Index] = NewVZ;
+
+			PreviousX[Index] = PositionX[Index];
+			PreviousY[Index] = PositionY[Index];
+			PreviousZ[Index] = PositionZ[Index];
+			PositionX[Index] += NewVX * StepTime;
+			PositionY[Index] += NewVY * StepTime;
+			PositionZ[Index] += NewVZ * StepTime;
+
+			Lifetime[Index] -= StepTime;
+		}
+	}, NumChunks < 2);
+}
+
+void UShooterProjectileSubsystem::SweepProjectiles()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileSweep);
+	CSV_SCOPED_TIMING_STAT(Shooter, ProjectileSweep);
+
+	const int32 NumProjectiles = Projectiles.Num();
+
+	// Weak pointers are resolved here rather than on the workers
+	IgnoredActors.SetNum(NumProjectiles, false);
+	for (int32 Index = 0; Index < NumProjectiles; ++Index)
+	{
+		IgnoredActors[Index] = Projectiles.Instigator[Index].Get();
+	}
+
+	// Scene queries are safe to run concurrently once physics has finished for the frame
+	const UWorld* World = GetWorld();
+	SweepHits.SetNum(NumProjectiles, false);
+	ParallelFor(NumProjectiles, [this, World](int32 Index)
+	{
+		const FVector Start(Projectiles.PreviousX[Index], Projectiles.PreviousY[Index], Projectiles.PreviousZ[Index]);
+		const FVector End(Projectiles.PositionX[Index], Projectiles.PositionY[Index], Projectiles.PositionZ[Index]);
+		if (Start.Equals(End))
+		{
+			// Fired right at the end of the frame, it hasn't gone anywhere yet
+			SweepHits[Index].Reset(1.f, false);
+			return;
+		}
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileSweep));
+		QueryParams.AddIgnoredActor(IgnoredActors[Index]);
+		World->LineTraceSingleByChannel(SweepHits[Index], Start, End, ECollisionChannel::ECC_Visibility, QueryParams);
+	}, NumProjectiles < CVarProjectileSweepParallelThreshold.GetValueOnGameThread());
+}
+
+void UShooterProjectileSubsystem::ResolveProjectiles()
+{
+	int32 NumImpacts = 0;
+
+	// Walk backwards so swapping the last round into a removed slot never skips one
+	for (int32 Index = Projectiles.Num() - 1; Index >= 0; --Index)
+	{
+		const FHitResult& Hit = SweepHits[Index];
+		if (Hit.bBlockingHit)
+		{
+			NumImpacts++;
+
+			AShooterCharacter* Instigator = Projectiles.Instigator[Index].Get();
+			if (Instigator)
+			{
+				// Impacts share the hitscan result path, so FX and any hit handling stay in one place
+				FHitscanShotResult Result;
+				Result.WeaponDefinition = Projectiles.WeaponDefinition[Index];
+				Result.MuzzleTransform = FTransform(Projectiles.LaunchLocation[Index]);
+				Result.BeamEnd = Hit.Location;
+				Result.bHit = true;
+				Result.Hit = Hit;
+				Instigator->OnShotResolved(Result);
+			}
+		}
+
+		if (Hit.bBlockingHit || Projectiles.Lifetime[Index] <= 0.f)
+		{
+			Projectiles.RemoveAtSwap(Index);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_ProjectileImpacts, NumImpacts);
+	CSV_CUSTOM_STAT(Shooter, ProjectileImpacts, NumImpacts, ECsvCustomStatOp::Set);
+}
+
+void UShooterProjectileSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileTick);
+	CSV_SCOPED_TIMING_STAT(Shooter, ProjectileTick);
+
+	const double StartTime = FPlatformTime::Seconds();
+	LastTickProjectiles = Projectiles.Num();
+	CSV_CUSTOM_STAT(Shooter, LiveProjectiles, LastTickProjectiles, ECsvCustomStatOp::Set);
+
+	Integrate(DeltaTime);
+	SweepProjectiles();
+	ResolveProjectiles();
+
+	SET_DWORD_STAT(STAT_LiveProjectiles, Projectiles.Num());
+	LastTickSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+bool UShooterProjectileSubsystem::IsTickable() const
+{
+	return Projectiles.Num() > 0;
+}
+
+ETickableTickType UShooterProjectileSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UShooterProjectileSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UShooterProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterProjectileSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterProjectileSubsystem.generated.h"
+
+class AShooterCharacter;
+class UWeaponDefinition;
+
+/**
+ * Every live round in structure-of-arrays form. Integration only touches the float arrays,
+ * so each component streams through the cache and the inner loop can be vectorized.
+ */
+struct FShooterProjectileData
+{
+	/** Current position, cm */
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+
+	/** Position at the start of this frame's step, the start of its sweep */
+	TArray<float> PreviousX;
+	TArray<float> PreviousY;
+	TArray<float> PreviousZ;
+
+	/** Velocity, cm/s */
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+
+	/** Quadratic drag coefficient, deceleration is Drag * Speed^2 */
+	TArray<float> Drag;
+
+	/** Seconds left before the round expires */
+	TArray<float> Lifetime;
+
+	/** How far the first step of a round fired this frame goes, negative once it has taken it */
+	TArray<float> FirstStepTime;
+
+	/** Cold data, only read when a round hits */
+	TArray<TWeakObjectPtr<AShooterCharacter>> Instigator;
+	TArray<const UWeaponDefinition*> WeaponDefinition;
+	TArray<FVector> LaunchLocation;
+
+	FORCEINLINE int32 Num() const { return Lifetime.Num(); };
+
+	void Add(const FVector& Location, const FVector& Velocity, float InDrag, float InLifetime, AShooterCharacter* InInstigator, const UWeaponDefinition* InWeaponDefinition, float InFirstStepTime);
+	void RemoveAtSwap(int32 Index);
+	void Reserve(int32 Number);
+	void Empty();
+};
+
+/**
+ * Simulates ballistic rounds without an actor or component per bullet. Each frame every round is
+ * integrated in parallel chunks, then all of them sweep along the step they took as one batch
+ * spread across worker threads. Impacts are handed back to the instigating character the same way
+ * hitscan results are.
+ */
+UCLASS()
+class SHOOTER_API UShooterProjectileSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Launches a round. Returns false if the round budget is full, in which case the caller should fall back to hitscan.
+	 * FlightTime is how long before the end of this frame the round was fired, which is as far as its first step goes.
+	 */
+	bool LaunchProjectile(const FVector& Location, const FVector& Velocity, float Drag, float Lifetime,
+		AShooterCharacter* Instigator = nullptr, const UWeaponDefinition* WeaponDefinition = nullptr, float FlightTime = 0.f);
+
+	/** Removes every live round */
+	void ClearProjectiles();
+
+	FORCEINLINE int32 GetNumProjectiles() const { return Projectiles.Num(); };
+
+	/** Rounds simulated by the last tick and how long it took, for benchmarks */
+	FORCEINLINE int32 GetLastTickProjectiles() const { return LastTickProjectiles; };
+	FORCEINLINE double GetLastTickSeconds() const { return LastTickSeconds; };
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Advances every round by DeltaTime under gravity and drag */
+	void Integrate(float DeltaTime);
+
+	/** Sweeps every round from its previous to its current position */
+	void SweepProjectiles();
+
+	/** Hands impacts back to instigators and removes rounds that hit or expired */
+	void ResolveProjectiles();
+
+	FShooterProjectileData Projectiles;
+
+	/** Sweep results for each round, kept around to avoid reallocating every frame */
+	TArray<FHitResult> SweepHits;
+
+	/** Instigators resolved on the game thread, so sweeps can ignore them from worker threads */
+	TArray<const AActor*> IgnoredActors;
+
+	int32 LastTickProjectiles = 0;
+	double LastTickSeconds = 0.0;
+};
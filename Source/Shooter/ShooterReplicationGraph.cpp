@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterReplicationGraph.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerController.h"
+#include "UObject/UObjectIterator.h"
+#include "Item.h"
+#include "Weapon.h"
+#include "ShooterCharacter.h"
+
+static TAutoConsoleVariable<float> CVarRepGraphCellSize(
+	TEXT("Shooter.RepGraph.CellSize"),
+	10000.f,
+	TEXT("Size of the replication graph's spatial grid cells. Read when the graph is created."),
+	ECVF_Default);
+
+void UShooterReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	ReplicationActorList.Reset();
+
+	for (const FNetViewer& Viewer : Params.Viewers)
+	{
+		ReplicationActorList.ConditionalAdd(Viewer.InViewer);
+		ReplicationActorList.ConditionalAdd(Viewer.ViewTarget);
+
+		const APlayerController* PlayerController = Cast<APlayerController>(Viewer.InViewer);
+		if (PlayerController && PlayerController->GetPawn() != Viewer.ViewTarget)
+		{
+			ReplicationActorList.ConditionalAdd(PlayerController->GetPawn());
+		}
+	}
+
+	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+}
+
+UShooterReplicationGraph::UShooterReplicationGraph() :
+	GridNode(nullptr),
+	AlwaysRelevantNode(nullptr)
+{
+}
+
+bool UShooterReplicationGraph::IsSpatialized(const AActor* Actor)
+{
+	return !Actor->bAlwaysRelevant && !Actor->bOnlyRelevantToOwner && !Actor->IsA<AInfo>();
+}
+
+void UShooterReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	const float ServerMaxTickRate = NetDriver ? NetDriver->NetServerMaxTickRate : 30.f;
+
+	// Every replicated class replicates at its NetUpdateFrequency, and spatialized ones cull at their NetCullDistanceSquared.
+	// Blueprint classes loaded later fall back to their closest native parent
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+		if (ActorCDO == nullptr || !ActorCDO->GetIsReplicated()) continue;
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) continue;
+
+		FClassReplicationInfo ClassInfo;
+		if (IsSpatialized(ActorCDO))
+		{
+			ClassInfo.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+		}
+		ClassInfo.ReplicationPeriodFrame = FMath::Max<uint32>(FMath::RoundToInt(ServerMaxTickRate / ActorCDO->NetUpdateFrequency), 1);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+
+	ItemStateChangedHandle = AItem::OnItemStateChanged.AddUObject(this, &UShooterReplicationGraph::OnItemStateChanged);
+	EquipWeaponHandle = AShooterCharacter::NotifyEquipWeapon.AddUObject(this, &UShooterReplicationGraph::OnCharacterEquipWeapon);
+}
+
+void UShooterReplicationGraph::InitGlobalGraphNodes()
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = CVarRepGraphCellSize.GetValueOnGameThread();
+	GridNode->SpatialBias = FVector2D(-WORLD_MAX, -WORLD_MAX);
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UShooterReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	UShooterReplicationGraphNode_AlwaysRelevant_ForConnection* AlwaysRelevantForConnectionNode = CreateNewNode<UShooterReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(AlwaysRelevantForConnectionNode, RepGraphConnection);
+}
+
+void UShooterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	AActor* Actor = ActorInfo.Actor;
+
+	if (AItem* Item = Cast<AItem>(Actor))
+	{
+		RouteItem(Item, GlobalInfo);
+	}
+	else if (Actor->IsA<APlayerController>() || Actor->bOnlyRelevantToOwner)
+	{
+		// Replicated to its own connection by UShooterReplicationGraphNode_AlwaysRelevant_ForConnection
+	}
+	else if (IsSpatialized(Actor))
+	{
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+	}
+	else
+	{
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+	}
+}
+
+void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	AActor* Actor = ActorInfo.Actor;
+
+	if (AItem* Item = Cast<AItem>(Actor))
+	{
+		UnrouteItem(Item);
+		ItemRoutes.Remove(Item);
+	}
+	else if (Actor->IsA<APlayerController>() || Actor->bOnlyRelevantToOwner)
+	{
+	}
+	else if (IsSpatialized(Actor))
+	{
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+	}
+	else
+	{
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+	}
+}
+
+void UShooterReplicationGraph::RouteItem(AItem* Item, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	UnrouteItem(Item);
+
+	EShooterItemRoute Route = EShooterItemRoute::None;
+	switch (Item->GetItemState())
+	{
+	case EItemState::EIS_Pickup:
+		// Pickups don't move, so they are placed in their grid cells once
+		GridNode->AddActor_Static(FNewReplicatedActorInfo(Item), GlobalInfo);
+		Route = EShooterItemRoute::GridStatic;
+		break;
+
+	case EItemState::EIS_EquipInterping:
+	case EItemState::EIS_Falling:
+		GridNode->AddActor_Dynamic(FNewReplicatedActorInfo(Item), GlobalInfo);
+		Route = EShooterItemRoute::GridDynamic;
+		break;
+
+	default:
+		// Equipped weapons replicate with the character holding them, see OnCharacterEquipWeapon
+		break;
+	}
+	ItemRoutes.Add(Item, Route);
+}
+
+void UShooterReplicationGraph::UnrouteItem(AItem* Item)
+{
+	const EShooterItemRoute* Route = ItemRoutes.Find(Item);
+	if (Route == nullptr) return;
+
+	switch (*Route)
+	{
+	case EShooterItemRoute::GridStatic:
+		GridNode->RemoveActor_Static(FNewReplicatedActorInfo(Item));
+		break;
+	case EShooterItemRoute::GridDynamic:
+		GridNode->RemoveActor_Dynamic(FNewReplicatedActorInfo(Item));
+		break;
+	default:
+		break;
+	}
+	ItemRoutes.Add(Item, EShooterItemRoute::None);
+}
+
+void UShooterReplicationGraph::OnItemStateChanged(AItem* Item)
+{
+	// Only re-route items the graph already knows about, new actors are routed when they are added
+	if (Item->GetWorld() != GetWorld() || !ItemRoutes.Contains(Item)) return;
+
+	RouteItem(Item, GlobalActorReplicationInfoMap.Get(Item));
+}
+
+void UShooterReplicationGraph::OnCharacterEquipWeapon(AShooterCharacter* Character, AWeapon* NewWeapon, AWeapon* OldWeapon)
+{
+	if (Character == nullptr || Character->GetWorld() != GetWorld()) return;
+
+	if (OldWeapon && OldWeapon != NewWeapon)
+	{
+		GlobalActorReplicationInfoMap.RemoveDependentActor(Character, OldWeapon);
+	}
+	if (NewWeapon)
+	{
+		GlobalActorReplicationInfoMap.AddDependentActor(Character, NewWeapon);
+	}
+}
+
+void UShooterReplicationGraph::BeginDestroy()
+{
+	AItem::OnItemStateChanged.Remove(ItemStateChangedHandle);
+	AShooterCharacter::NotifyEquipWeapon.Remove(EquipWeaponHandle);
+
+	Super::BeginDestroy();
+}
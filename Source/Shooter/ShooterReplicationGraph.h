@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ShooterReplicationGraph.generated.h"
+
+class AItem;
+class AWeapon;
+class AShooterCharacter;
+
+/** Which node an item is currently replicated through */
+enum class EShooterItemRoute : uint8
+{
+	/** Not in a node. Equipped weapons replicate as dependents of their owner */
+	None,
+
+	/** Lying in the world as a pickup, a static actor in the grid */
+	GridStatic,
+
+	/** Moving (falling or interping), a dynamic actor in the grid */
+	GridDynamic
+};
+
+/** Always relevant to its own connection: the connection's player controller, pawn and view target */
+UCLASS()
+class SHOOTER_API UShooterReplicationGraphNode_AlwaysRelevant_ForConnection : public UReplicationGraphNode_AlwaysRelevant_ForConnection
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+};
+
+/**
+ * Replication graph for the Shooter module. Ground pickups sit in a spatial grid so each connection only
+ * considers the loot near it, equipped weapons replicate as dependents of the character holding them,
+ * and characters are relevant to the connections near them through the same grid.
+ * Pass -NoRepGraph on the command line to fall back to the default net driver relevancy.
+ */
+UCLASS(Transient, Config = Engine)
+class SHOOTER_API UShooterReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UShooterReplicationGraph();
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual void BeginDestroy() override;
+
+private:
+	/** Characters, projectiles and loot, culled by distance to each connection */
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	/** Game state, player states and anything else relevant to everyone */
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	/** True if the actor is culled by distance through the grid rather than always relevant */
+	static bool IsSpatialized(const AActor* Actor);
+
+	/** Puts an item in the node matching its state */
+	void RouteItem(AItem* Item, FGlobalActorReplicationInfo& GlobalInfo);
+
+	/** Takes an item out of whichever node it is in */
+	void UnrouteItem(AItem* Item);
+
+	void OnItemStateChanged(AItem* Item);
+	void OnCharacterEquipWeapon(AShooterCharacter* Character, AWeapon* NewWeapon, AWeapon* OldWeapon);
+
+	/** Node each replicated item is in */
+	TMap<AItem*, EShooterItemRoute> ItemRoutes;
+
+	FDelegateHandle ItemStateChangedHandle;
+	FDelegateHandle EquipWeaponHandle;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+/** How much detail a character is simulated in, from the player's own character down to distant ones nobody can see */
+UENUM(BlueprintType)
+enum class EShooterSignificance : uint8
+{
+	ESS_Local UMETA(DisplayName = "Local"),
+	ESS_High UMETA(DisplayName = "High"),
+	ESS_Medium UMETA(DisplayName = "Medium"),
+	ESS_Low UMETA(DisplayName = "Low"),
+
+	ESS_MAX UMETA(DisplayName = "DefaultMAX"),
+};
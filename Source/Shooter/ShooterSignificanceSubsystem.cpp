@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterSignificanceSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_SignificanceUpdate, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Local"), STAT_SignificanceLocal, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters High"), STAT_SignificanceHigh, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Medium"), STAT_SignificanceMedium, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Low"), STAT_SignificanceLow, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Every Frame"), STAT_AnimEveryFrame, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Interpolated"), STAT_AnimInterpolated, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Skipping"), STAT_AnimSkipping, STATGROUP_Shooter);
+
+static TAutoConsoleVariable<int32> CVarSignificanceEnabled(
+	TEXT("Shooter.Significance"),
+	1,
+	TEXT("If zero, every character that isn't locally controlled is treated as High significance and ticks every frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceUpdateInterval(
+	TEXT("Shooter.Significance.UpdateInterval"),
+	0.25f,
+	TEXT("Seconds between rescoring character significance."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceHighDistance(
+	TEXT("Shooter.Significance.HighDistance"),
+	2500.f,
+	TEXT("Characters closer than this to a viewer are High significance."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceMediumDistance(
+	TEXT("Shooter.Significance.MediumDistance"),
+	6000.f,
+	TEXT("Characters closer than this to a viewer are Medium significance, further ones Low."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceMediumTickInterval(
+	TEXT("Shooter.Significance.MediumTickInterval"),
+	0.1f,
+	TEXT("Actor tick interval in seconds for Medium significance characters."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSignificanceLowTickInterval(
+	TEXT("Shooter.Significance.LowTickInterval"),
+	0.5f,
+	TEXT("Actor tick interval in seconds for Low significance characters."),
+	ECVF_Default);
+
+void UShooterSignificanceSubsystem::Register(AShooterCharacter* Character)
+{
+	Characters.AddUnique(Character);
+
+	// Score newcomers on the next tick rather than waiting out the interval
+	TimeUntilUpdate = 0.f;
+}
+
+void UShooterSignificanceSubsystem::Unregister(AShooterCharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+}
+
+void UShooterSignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeUntilUpdate -= DeltaTime;
+	if (TimeUntilUpdate <= 0.f)
+	{
+		TimeUntilUpdate = CVarSignificanceUpdateInterval.GetValueOnGameThread();
+		UpdateSignificance();
+	}
+}
+
+void UShooterSignificanceSubsystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SignificanceUpdate);
+
+	UWorld* World = GetWorld();
+
+	// Servers score against every player, clients only have their own
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	// Nothing is rendered on a dedicated server, so visibility can only count against a character elsewhere
+	const bool bUseVisibility = World->GetNetMode() != NM_DedicatedServer;
+	const bool bEnabled = CVarSignificanceEnabled.GetValueOnGameThread() != 0;
+
+	FMemory::Memzero(TierCounts);
+	int32 NumAnimEveryFrame = 0;
+	int32 NumAnimInterpolated = 0;
+	int32 NumAnimSkipping = 0;
+	for (AShooterCharacter* Character : Characters)
+	{
+		EShooterSignificance Tier = EShooterSignificance::ESS_High;
+		if (Character->IsLocalPlayerCharacter())
+		{
+			Tier = EShooterSignificance::ESS_Local;
+		}
+		else if (bEnabled)
+		{
+			Tier = ScoreCharacter(Character, bUseVisibility);
+		}
+
+		float TickInterval = 0.f;
+		if (Tier == EShooterSignificance::ESS_Medium)
+		{
+			TickInterval = CVarSignificanceMediumTickInterval.GetValueOnGameThread();
+		}
+		else if (Tier == EShooterSignificance::ESS_Low)
+		{
+			TickInterval = CVarSignificanceLowTickInterval.GetValueOnGameThread();
+		}
+
+		Character->SetSignificance(Tier, TickInterval);
+		TierCounts[static_cast<int32>(Tier)]++;
+
+		// Rates the mesh's update rate optimization settled on last frame
+		const FAnimUpdateRateParameters* AnimUpdateRate = Character->GetMesh()->AnimUpdateRateParams;
+		if (AnimUpdateRate == nullptr || AnimUpdateRate->UpdateRate <= 1)
+		{
+			NumAnimEveryFrame++;
+		}
+		else if (AnimUpdateRate->ShouldInterpolateSkippedFrames())
+		{
+			NumAnimInterpolated++;
+		}
+		else
+		{
+			NumAnimSkipping++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_SignificanceLocal, GetNumInTier(EShooterSignificance::ESS_Local));
+	SET_DWORD_STAT(STAT_SignificanceHigh, GetNumInTier(EShooterSignificance::ESS_High));
+	SET_DWORD_STAT(STAT_SignificanceMedium, GetNumInTier(EShooterSignificance::ESS_Medium));
+	SET_DWORD_STAT(STAT_SignificanceLow, GetNumInTier(EShooterSignificance::ESS_Low));
+	SET_DWORD_STAT(STAT_AnimEveryFrame, NumAnimEveryFrame);
+	SET_DWORD_STAT(STAT_AnimInterpolated, NumAnimInterpolated);
+	SET_DWORD_STAT(STAT_AnimSkipping, NumAnimSkipping);
+}
+
+EShooterSignificance UShooterSignificanceSubsystem::ScoreCharacter(const AShooterCharacter* Character, bool bUseVisibility) const
+{
+	const FVector Location = Character->GetActorLocation();
+	float ClosestDistSquared = MAX_flt;
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		ClosestDistSquared = FMath::Min(ClosestDistSquared, FVector::DistSquared(Location, ViewLocation));
+	}
+
+	const float HighDistance = CVarSignificanceHighDistance.GetValueOnGameThread();
+	const float MediumDistance = CVarSignificanceMediumDistance.GetValueOnGameThread();
+
+	EShooterSignificance Tier = EShooterSignificance::ESS_Low;
+	if (ClosestDistSquared < FMath::Square(HighDistance))
+	{
+		Tier = EShooterSignificance::ESS_High;
+	}
+	else if (ClosestDistSquared < FMath::Square(MediumDistance))
+	{
+		Tier = EShooterSignificance::ESS_Medium;
+	}
+
+	// Characters nobody has seen lately drop a tier
+	if (bUseVisibility && Tier != EShooterSignificance::ESS_Low && !Character->GetMesh()->WasRecentlyRendered(CVarSignificanceUpdateInterval.GetValueOnGameThread()))
+	{
+		Tier = static_cast<EShooterSignificance>(static_cast<uint8>(Tier) + 1);
+	}
+
+	return Tier;
+}
+
+bool UShooterSignificanceSubsystem::IsTickable() const
+{
+	return Characters.Num() > 0;
+}
+
+ETickableTickType UShooterSignificanceSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UShooterSignificanceSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UShooterSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterSignificanceSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterSignificance.h"
+#include "ShooterSignificanceSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * Scores every character by distance to the nearest viewer and whether it was recently rendered,
+ * a few times a second, and hands each one a significance tier and matching tick interval.
+ * Characters of players on this machine are always ESS_Local and tick every frame.
+ */
+UCLASS()
+class SHOOTER_API UShooterSignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	void Register(AShooterCharacter* Character);
+	void Unregister(AShooterCharacter* Character);
+
+	/** Every registered character, on the server and on clients */
+	FORCEINLINE const TArray<AShooterCharacter*>& GetCharacters() const { return Characters; };
+
+	/** Number of characters currently in each tier */
+	FORCEINLINE int32 GetNumInTier(EShooterSignificance Tier) const { return TierCounts[static_cast<int32>(Tier)]; };
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Rescores every character and applies the new tiers */
+	void UpdateSignificance();
+
+	/** Works out the tier for a character that isn't locally controlled */
+	EShooterSignificance ScoreCharacter(const AShooterCharacter* Character, bool bUseVisibility) const;
+
+	UPROPERTY()
+	TArray<AShooterCharacter*> Characters;
+
+	/** Viewpoints of every player this machine scores against, gathered once per update */
+	TArray<FVector> ViewLocations;
+
+	/** Time until the next rescore */
+	float TimeUntilUpdate = 0.f;
+
+	int32 TierCounts[static_cast<int32>(EShooterSignificance::ESS_MAX)] = {};
+};
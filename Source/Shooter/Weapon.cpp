@@ -2,18 +2,63 @@
 
 
 #include "Weapon.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "ShooterInputReplaySubsystem.h"
+#include "Shooter.h"
 
 AWeapon::AWeapon():
 	ThrowWeaponTime(0.7f),
 	bFalling(false),
 	AmmoCount(30),
-	MagazineCapacity(30),
-	WeaponType(EWeaponType::EWT_SubmachineGun),
-	AmmoType(EAmmoType::EAT_9mm),
-	ReloadMontageSection(FName(TEXT("Reload_SMG"))),
-	ClipBoneName(TEXT("smg_clip"))
+	ClipBoneIndex(INDEX_NONE),
+	BarrelBoneIndex(INDEX_NONE)
 {
+	// Only tick while falling to keep the weapon upright, see ThrowWeapon / StopFalling.
+	// Blueprints implementing Event Tick tick all the time, see BeginPlay
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void AWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Only compared when marked dirty by DecrementAmmo, ReloadAmmo and SetMovingClip
+	FDoRepLifetimeParams PushParams;
+	PushParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, AmmoCount, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, bMovingClip, PushParams);
+}
+
+void AWeapon::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bHasScriptTick)
+	{
+		SetActorTickEnabled(true);
+	}
+
+	static bool bWarnedNoDefinition = false;
+	if (WeaponDefinition == nullptr && !bWarnedNoDefinition)
+	{
+		bWarnedNoDefinition = true;
+		UE_LOG(LogShooter, Warning, TEXT("%s has no WeaponDefinition, weapons without one use the UWeaponDefinition defaults"), *GetClass()->GetName());
+	}
+
+	// Resolve socket and bone indices once so firing and reloading can skip name lookups
+	ResolveMeshIndices();
+
+#if !UE_SERVER
+	if (!IsRunningDedicatedServer())
+	{
+		GetWeaponDefinition()->LoadCosmetics();
+	}
+#endif
 }
 
 void AWeapon::Tick(float DeltaTime)
@@ -38,12 +83,77 @@ void AWeapon::DecrementAmmo()
 	{
 		--AmmoCount;
 	}
+	MARK_PROPERTY_DIRTY_FROM_NAME(AWeapon, AmmoCount, this);
+	OnAmmoChanged.Broadcast(this);
 }
 
 void AWeapon::ReloadAmmo(int32 Amount)
 {
-	checkf(AmmoCount + Amount <= MagazineCapacity, TEXT("Attempted to reload with more than magazine capacity"));
+	checkf(AmmoCount + Amount <= GetMagazineCapacity(), TEXT("Attempted to reload with more than magazine capacity"));
+	if (Amount == 0) return;
+
 	AmmoCount += Amount;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AWeapon, AmmoCount, this);
+	OnAmmoChanged.Broadcast(this);
+}
+
+void AWeapon::OnRep_AmmoCount()
+{
+	OnAmmoChanged.Broadcast(this);
+}
+
+void AWeapon::SetMovingClip(bool Moving)
+{
+	bMovingClip = Moving;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AWeapon, bMovingClip, this);
+}
+
+void AWeapon::ResolveMeshIndices()
+{
+	const USkeletalMesh* Mesh = GetItemMesh()->SkeletalMesh;
+	ResolvedMesh = Mesh;
+	ClipBoneIndex = INDEX_NONE;
+	BarrelBoneIndex = INDEX_NONE;
+	if (Mesh == nullptr) return;
+
+	const UWeaponDefinition* Definition = GetWeaponDefinition();
+	ClipBoneIndex = Mesh->GetRefSkeleton().FindBoneIndex(Definition->GetClipBoneName());
+
+	const USkeletalMeshSocket* BarrelSocket = Mesh->FindSocket(Definition->GetBarrelSocketName());
+	if (BarrelSocket)
+	{
+		BarrelBoneIndex = Mesh->GetRefSkeleton().FindBoneIndex(BarrelSocket->BoneName);
+		BarrelSocketLocalTransform = BarrelSocket->GetSocketLocalTransform();
+	}
+}
+
+int32 AWeapon::GetClipBoneIndex() const
+{
+	// The mesh was swapped since BeginPlay, look the bone up by name
+	if (GetItemMesh()->SkeletalMesh != ResolvedMesh.Get())
+	{
+		return GetItemMesh()->GetBoneIndex(GetWeaponDefinition()->GetClipBoneName());
+	}
+	return ClipBoneIndex;
+}
+
+bool AWeapon::GetBarrelSocketTransform(FTransform& OutTransform) const
+{
+	const USkeletalMeshComponent* MeshComponent = GetItemMesh();
+	if (MeshComponent->SkeletalMesh != ResolvedMesh.Get())
+	{
+		// The mesh was swapped since BeginPlay, look the socket up by name
+		const FName BarrelSocketName = GetWeaponDefinition()->GetBarrelSocketName();
+		if (!MeshComponent->DoesSocketExist(BarrelSocketName)) return false;
+
+		OutTransform = MeshComponent->GetSocketTransform(BarrelSocketName);
+		return true;
+	}
+
+	if (BarrelBoneIndex == INDEX_NONE) return false;
+
+	OutTransform = BarrelSocketLocalTransform * MeshComponent->GetBoneTransform(BarrelBoneIndex);
+	return true;
 }
 
 void AWeapon::ThrowWeapon()
@@ -57,12 +167,16 @@ void AWeapon::ThrowWeapon()
 	// Direction we throw the weapon
 	FVector ImpulseDirection = MeshRight.RotateAngleAxis(-20, MeshForward);
 
-	float RandomRotation = FMath::FRandRange(15, 45);
+	// Seeded through the input replay so recorded sessions throw the same way when replayed
+	UShooterInputReplaySubsystem* InputReplay = GetWorld()->GetSubsystem<UShooterInputReplaySubsystem>();
+	FRandomStream ThrowRandom(InputReplay ? InputReplay->NextRandomSeed() : FMath::Rand());
+	float RandomRotation = ThrowRandom.FRandRange(15, 45);
 	ImpulseDirection = MeshRight.RotateAngleAxis(RandomRotation, FVector(0.f, 0.f, 1.f));
 
 	ImpulseDirection *= 5000.f;
 	GetItemMesh()->AddImpulse(ImpulseDirection);
 	bFalling = true;
+	SetActorTickEnabled(true);
 
 	GetWorldTimerManager().SetTimer(ThrowWeaponTimer, this, &AWeapon::StopFalling, ThrowWeaponTime);
 }
@@ -70,5 +184,9 @@ void AWeapon::ThrowWeapon()
 void AWeapon::StopFalling()
 {
 	bFalling = false;
+	SetActorTickEnabled(bHasScriptTick);
 	SetItemState(EItemState::EIS_Pickup);
+
+	// Landed, nothing about it changes until it is picked up or thrown again
+	GoDormant();
 }
\ No newline at end of file
@@ -5,16 +5,13 @@
 #include "CoreMinimal.h"
 #include "Item.h"
 #include "AmmoType.h"
+#include "WeaponType.h"
+#include "WeaponDefinition.h"
 #include "Weapon.generated.h"
 
-UENUM(BlueprintType)
-enum class EWeaponType : uint8
-{
-	EWT_SubmachineGun UMETA(DisplayName = "Submachine Gun"),
-	EWT_AssaultRifle UMETA(DisplayName = "Assault Rifle"),
+class USkeletalMesh;
 
-	EWT_MAX UMETA(DisplayName = "Default MAX")
-};
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnWeaponAmmoChanged, class AWeapon*);
 
 /**
  * 
@@ -27,8 +24,11 @@ class SHOOTER_API AWeapon : public AItem
 public:
 	AWeapon();
 	virtual void Tick(float DeltaTime) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 protected:
+	virtual void BeginPlay() override;
+
 	void StopFalling();
 
 private:
@@ -37,48 +37,58 @@ private:
 	bool bFalling;
 
 	/** Ammo count for this weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_AmmoCount, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
 	int32 AmmoCount;
 
-	/** Maximum ammo this weapon can hold */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
-	int32 MagazineCapacity;
+	UFUNCTION()
+	void OnRep_AmmoCount();
 
-	/** Type of weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
-	EWeaponType WeaponType;
-
-	/** The type of ammo for this weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
-	EAmmoType AmmoType;
-
-	/** Name of the reload montage section for this weapon*/
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
-	FName ReloadMontageSection;
+	/** Static data shared by all weapons of this type. Weapons without one use the UWeaponDefinition class defaults */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	UWeaponDefinition* WeaponDefinition;
 
 	/** True when the clip is moving during the reload */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Replicated, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
 	bool bMovingClip;
 
-	/** The name of the skeletal bone representing the ammo clip */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
-	FName ClipBoneName;
+	/** Mesh the indices below were resolved against. Weapons sharing a definition can use different meshes */
+	TWeakObjectPtr<const USkeletalMesh> ResolvedMesh;
+
+	/** Bone index of the definition's clip bone on ResolvedMesh */
+	int32 ClipBoneIndex;
+
+	/** Bone the barrel socket is attached to on ResolvedMesh, and the socket's transform relative to it */
+	int32 BarrelBoneIndex;
+	FTransform BarrelSocketLocalTransform;
+
+	/** Looks up the definition's clip bone and barrel socket on the item mesh */
+	void ResolveMeshIndices();
 public:
 	// Adds an impulse to the drop-weapon mechanism
 	void ThrowWeapon();
 
 	FORCEINLINE int32 GetAmmoCount() const{ return AmmoCount; };
-	FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; };
+	/** Never nullptr, falls back to the class defaults (the SMG) when no definition is assigned */
+	FORCEINLINE const UWeaponDefinition* GetWeaponDefinition() const { return WeaponDefinition ? WeaponDefinition : GetDefault<UWeaponDefinition>(); };
+	FORCEINLINE int32 GetMagazineCapacity() const { return GetWeaponDefinition()->GetMagazineCapacity(); };
 
 	/** Called from character class when firing weapon */
 	void DecrementAmmo();
 
-	FORCEINLINE EWeaponType GetWeaponType() const { return WeaponType; };
-	FORCEINLINE EAmmoType GetAmmoType() const { return AmmoType; };
-	FORCEINLINE FName GetReloadMontageSection() const{ return ReloadMontageSection; };
+	FORCEINLINE EWeaponType GetWeaponType() const { return GetWeaponDefinition()->GetWeaponType(); };
+	FORCEINLINE EAmmoType GetAmmoType() const { return GetWeaponDefinition()->GetAmmoType(); };
+	FORCEINLINE FName GetReloadMontageSection() const{ return GetWeaponDefinition()->GetReloadMontageSection(); };
 
 	void ReloadAmmo(int32 Amount);
-	FORCEINLINE FName GetClipBoneName() const { return ClipBoneName; };
 
-	FORCEINLINE void SetMovingClip(bool Moving) { bMovingClip = Moving; };
+	/** Bone index of the clip, resolved in BeginPlay */
+	int32 GetClipBoneIndex() const;
+
+	/** World transform of the barrel socket, using the bone and socket resolved in BeginPlay */
+	bool GetBarrelSocketTransform(FTransform& OutTransform) const;
+
+	void SetMovingClip(bool Moving);
+
+	/** Broadcast whenever AmmoCount changes, on the server and on clients as it replicates */
+	FOnWeaponAmmoChanged OnAmmoChanged;
 };
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponDefinition.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Sound/SoundCue.h"
+#include "Particles/ParticleSystem.h"
+
+UWeaponDefinition::UWeaponDefinition() :
+	WeaponType(EWeaponType::EWT_SubmachineGun),
+	AmmoType(EAmmoType::EAT_9mm),
+	MagazineCapacity(30),
+	AutomaticFireRate(0.1f),
+	ReloadMontageSection(FName(TEXT("Reload_SMG"))),
+	ClipBoneName(TEXT("smg_clip")),
+	BarrelSocketName(TEXT("BarrelSocket")),
+	bBallistic(false),
+	MuzzleVelocity(40000.f),
+	ProjectileDrag(0.00001f),
+	ProjectileLifetime(3.f)
+{
+
+}
+
+void UWeaponDefinition::LoadCosmetics() const
+{
+	if (CosmeticsHandle.IsValid()) return;
+
+	TArray<FSoftObjectPath> Cosmetics;
+	for (const FSoftObjectPath& Path : { FireSound.ToSoftObjectPath(), MuzzleFlash.ToSoftObjectPath(), ImpactParticles.ToSoftObjectPath(), BeamParticles.ToSoftObjectPath() })
+	{
+		if (!Path.IsNull())
+		{
+			Cosmetics.Add(Path);
+		}
+	}
+
+	if (Cosmetics.Num() > 0)
+	{
+		CosmeticsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Cosmetics);
+	}
+}
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "AmmoType.h"
+#include "WeaponType.h"
+#include "WeaponDefinition.generated.h"
+
+class USoundCue;
+class UParticleSystem;
+struct FStreamableHandle;
+
+/**
+ * Static data shared by every weapon of one type. Weapon instances only carry their
+ * mutable state, the bone indices resolved on their own mesh and a pointer to their definition.
+ */
+UCLASS(BlueprintType)
+class SHOOTER_API UWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponDefinition();
+
+	/** Starts loading the sounds and particles. Never called on dedicated servers, so they don't load there */
+	void LoadCosmetics() const;
+
+private:
+	/** Type of weapon */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	EWeaponType WeaponType;
+
+	/** The type of ammo for this weapon */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	EAmmoType AmmoType;
+
+	/** Maximum ammo this weapon can hold */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	int32 MagazineCapacity;
+
+	/** Rate of automatic weapon fire */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	float AutomaticFireRate;
+
+	/** Name of the reload montage section for this weapon*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	FName ReloadMontageSection;
+
+	/** The name of the skeletal bone representing the ammo clip */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	FName ClipBoneName;
+
+	/** The name of the socket at the end of the barrel */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Weapon Props", meta = (AllowPrivateAccess = "true"))
+	FName BarrelSocketName;
+
+	/** Fire simulated rounds that travel under gravity and drag instead of resolving shots instantly */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ballistics", meta = (AllowPrivateAccess = "true"))
+	bool bBallistic;
+
+	/** Speed rounds leave the barrel at, cm/s */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ballistics", meta = (AllowPrivateAccess = "true", EditCondition = "bBallistic", ClampMin = "0.0"))
+	float MuzzleVelocity;
+
+	/** Quadratic drag coefficient, rounds decelerate by ProjectileDrag * Speed^2 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ballistics", meta = (AllowPrivateAccess = "true", EditCondition = "bBallistic", ClampMin = "0.0"))
+	float ProjectileDrag;
+
+	/** Seconds a round flies for before it is discarded */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ballistics", meta = (AllowPrivateAccess = "true", EditCondition = "bBallistic", ClampMin = "0.0"))
+	float ProjectileLifetime;
+
+	/** Randomised gunshot sound cue */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<USoundCue> FireSound;
+
+	/** Muzzle flash spawned at BarrelSocket */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
+
+	/** Impact particles spawned on bullet impact */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UParticleSystem> ImpactParticles;
+
+	/** Smoke trail for bullets */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Combat", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UParticleSystem> BeamParticles;
+
+	/** Keeps the cosmetic assets loaded once LoadCosmetics has been called */
+	mutable TSharedPtr<FStreamableHandle> CosmeticsHandle;
+
+public:
+	FORCEINLINE EWeaponType GetWeaponType() const { return WeaponType; };
+	FORCEINLINE EAmmoType GetAmmoType() const { return AmmoType; };
+	FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; };
+	FORCEINLINE float GetAutomaticFireRate() const { return AutomaticFireRate; };
+	FORCEINLINE FName GetReloadMontageSection() const { return ReloadMontageSection; };
+	FORCEINLINE FName GetClipBoneName() const { return ClipBoneName; };
+	FORCEINLINE FName GetBarrelSocketName() const { return BarrelSocketName; };
+	FORCEINLINE bool IsBallistic() const { return bBallistic; };
+	FORCEINLINE float GetMuzzleVelocity() const { return MuzzleVelocity; };
+	FORCEINLINE float GetProjectileDrag() const { return ProjectileDrag; };
+	FORCEINLINE float GetProjectileLifetime() const { return ProjectileLifetime; };
+
+	/** Cosmetic assets, nullptr until LoadCosmetics has finished loading them */
+	FORCEINLINE USoundCue* GetFireSound() const { return FireSound.Get(); };
+	FORCEINLINE UParticleSystem* GetMuzzleFlash() const { return MuzzleFlash.Get(); };
+	FORCEINLINE UParticleSystem* GetImpactParticles() const { return ImpactParticles.Get(); };
+	FORCEINLINE UParticleSystem* GetBeamParticles() const { return BeamParticles.Get(); };
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EWeaponType : uint8
+{
+	EWT_SubmachineGun UMETA(DisplayName = "Submachine Gun"),
+	EWT_AssaultRifle UMETA(DisplayName = "Assault Rifle"),
+
+	EWT_MAX UMETA(DisplayName = "Default MAX")
+};
\ No newline at end of file
@@ -9,6 +9,7 @@ public class ShooterEditorTarget : TargetRules
 	{
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
+		bWithPushModel = true;
 		ExtraModuleNames.AddRange( new string[] { "Shooter" } );
 	}
 }
@@ -0,0 +1,15 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class ShooterServerTarget : TargetRules
+{
+	public ShooterServerTarget( TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		bWithPushModel = true;
+		ExtraModuleNames.AddRange( new string[] { "Shooter" } );
+	}
+}